@@ -61,6 +61,16 @@ struct storage_t {
     write(const std::string& collection, const std::string& key, const std::string& blob,
           const std::vector<std::string>& tags) = 0;
 
+    // Writes the blob right from the given buffer. Backends which are able to consume it without a
+    // string should override this, the default implementation copies the blob.
+    virtual
+    void
+    write(const std::string& collection, const std::string& key, const char* blob, size_t size,
+          const std::vector<std::string>& tags)
+    {
+        write(collection, key, std::string(blob, size), tags);
+    }
+
     virtual
     void
     remove(const std::string& collection, const std::string& key) = 0;
@@ -65,6 +65,13 @@ public:
         // I/O thread pool size.
         size_t pool;
 
+        // Whether to collect per-slot invocation metrics, exposed via the Locator. Off by default.
+        bool metrics;
+
+        // Whether every I/O thread should accept connections on its own SO_REUSEPORT socket instead
+        // of receiving them from the service thread. Requires kernel support, Linux 3.9 or newer.
+        bool reuseport;
+
         struct {
             // Pinned ports for static service port allocation.
             std::map<std::string, port_t> pinned;
@@ -72,6 +79,40 @@ public:
             // Port range to populate the dynamic port pool for service port allocation.
             std::tuple<port_t, port_t> shared;
         } ports;
+
+        struct {
+            // Maximum number of messages and bytes coalesced into a single gather write. Messages
+            // pushed into a session during one reactor turn are flushed together, trading a bit of
+            // latency for fewer syscalls. Zero buffers (default) disables the write batching.
+            size_t buffers;
+            size_t bytes;
+        } batching;
+
+        struct {
+            // Initial and maximum sizes of per-connection receive buffers. Buffers grow to fit larger
+            // messages and shrink back once the connection is idle. Zero maximum means no limit.
+            size_t initial;
+            size_t maximum;
+        } ring;
+
+        struct {
+            // Per-session flow control. When the amount of outgoing data not yet consumed by the
+            // client grows over the high watermark, the session stops reading requests until it
+            // drains below the low watermark. Zero high watermark (default) disables it.
+            size_t high;
+            size_t low;
+        } watermarks;
+
+        struct {
+            // CPU sets to pin execution units to, assigned to units in a round-robin fashion. With
+            // one set per NUMA node, units are spread evenly between the nodes, and since sessions
+            // are set up on the unit's own thread, their buffers come from node-local memory. Empty
+            // means no pinning (default).
+            std::vector<std::vector<unsigned int>> units;
+
+            // CPU set to pin service threads to, empty means no pinning (default).
+            std::vector<unsigned int> services;
+        } affinity;
     } network;
 
     struct logging_t {
@@ -212,6 +253,9 @@ public:
     auto
     engine() -> execution_unit_t&;
 
+    auto
+    pool() const -> const std::vector<std::unique_ptr<execution_unit_t>>&;
+
     // Raft
 
 #ifdef COCAINE_ALLOW_RAFT
@@ -36,6 +36,8 @@ struct defaults {
     static const unsigned long queue_limit;
     static const unsigned long concurrency;
     static const unsigned long crashlog_limit;
+    static const unsigned long warm_pool;
+    static const unsigned long pool_minimum;
 
     // Default I/O policy.
     static const float control_timeout;
@@ -46,6 +48,10 @@ struct defaults {
 
     // Defaults for networking.
     static const std::string endpoint;
+    static const unsigned long batch_buffers;
+    static const unsigned long batch_bytes;
+    static const unsigned long ring_initial_size;
+    static const unsigned long ring_maximum_size;
 
     // Defaults for logging service.
     static const std::string log_verbosity;
@@ -49,6 +49,11 @@ class actor_t {
     // is accepted, it is assigned to a carefully choosen thread from the main thread pool.
     std::unique_ptr<asio::ip::tcp::acceptor> m_acceptor;
 
+    // Per-unit I/O acceptors. In SO_REUSEPORT mode, every execution unit listens on the service port
+    // by itself, and the kernel distributes new connections between them. Each of these acceptors is
+    // owned by its unit's reactor, so they are only closed there.
+    std::vector<std::shared_ptr<asio::ip::tcp::acceptor>> m_acceptors;
+
     // I/O authentication & processing.
     std::unique_ptr<io::chamber_t> m_chamber;
 
@@ -79,6 +84,10 @@ public:
 
     void
     terminate();
+
+private:
+    auto
+    local_endpoint() const -> asio::ip::tcp::endpoint;
 };
 
 } // namespace cocaine
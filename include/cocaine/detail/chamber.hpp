@@ -24,6 +24,10 @@
 #include "cocaine/common.hpp"
 #include "cocaine/locked_ptr.hpp"
 
+#include "cocaine/rpc/metrics.hpp"
+
+#include <chrono>
+
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/rolling_mean.hpp>
 
@@ -38,12 +42,21 @@ namespace cocaine { namespace io {
 class chamber_t {
     class named_runnable_t;
     class stats_periodic_action_t;
+    class lag_periodic_action_t;
 
     static const unsigned int kCollectionInterval = 2;
 
+    // Scheduling lag is probed every kProbeInterval milliseconds, and averaged over kProbeWindow
+    // last probes.
+    static const unsigned int kProbeInterval = 100;
+    static const unsigned int kProbeWindow   = 10;
+
     const std::string name;
     const std::shared_ptr<asio::io_service> asio;
 
+    // CPUs this chamber's thread is allowed to run on, empty means no restrictions.
+    const std::vector<unsigned int> cpus;
+
     // Takes resource usage snapshots every kCollectInterval seconds.
     asio::deadline_timer cron;
 
@@ -58,19 +71,59 @@ class chamber_t {
     // Rolling resource usage mean over last minute.
     synchronized<load_average_t> load_acc1;
 
+    // Scheduling lag, i.e. the time handlers spend in the reactor queue before they're run. The
+    // probe action only holds it by a weak pointer: the owner might stop the reactor with a probe
+    // still in the queue, which would then run after the chamber is gone, once restarted.
+    struct lag_state_t {
+        COCAINE_DECLARE_NONCOPYABLE(lag_state_t)
+
+        explicit
+        lag_state_t(asio::io_service& asio);
+
+        // Schedules the probes. Stopped on the reactor thread before termination.
+        asio::deadline_timer probe;
+        bool stopped;
+
+        // Recent rolling mean, in microseconds, and the distribution over the chamber's lifetime.
+        synchronized<load_average_t> mean;
+        histogram_t histogram;
+    };
+
+    const std::shared_ptr<lag_state_t> lag_state;
+
 public:
-    chamber_t(const std::string& name, const std::shared_ptr<asio::io_service>& asio);
+    chamber_t(const std::string& name, const std::shared_ptr<asio::io_service>& asio,
+              const std::vector<unsigned int>& cpus = std::vector<unsigned int>());
    ~chamber_t();
 
+    auto
+    affinity() const -> const std::vector<unsigned int>& {
+        return cpus;
+    }
+
     auto
     load_avg1() const -> double {
         return boost::accumulators::rolling_mean(*load_acc1.synchronize());
     }
 
+    auto
+    lag_avg() const -> double {
+        return boost::accumulators::rolling_mean(*lag_state->mean.synchronize());
+    }
+
+    auto
+    lag() const -> const histogram_t& {
+        return lag_state->histogram;
+    }
+
     auto
     uuid() const -> boost::thread::id {
         return thread->get_id();
     }
+
+private:
+    void
+    pin();
 };
 
 }} // namespace cocaine::io
@@ -23,6 +23,10 @@
 
 #include "cocaine/common.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <functional>
+
 #include <asio/io_service.hpp>
 #include <asio/ip/tcp.hpp>
 
@@ -33,11 +37,35 @@ class session_t;
 class execution_unit_t {
     COCAINE_DECLARE_NONCOPYABLE(execution_unit_t)
 
+    class accept_action_t;
+    class inspect_action_t;
+
+#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
+    typedef std::chrono::steady_clock clock_type;
+#else
+    typedef std::chrono::monotonic_clock clock_type;
+#endif
+
+    // Message counters of a session at the time of the previous inspection, to calculate rates.
+    struct sample_t {
+        uint64_t received;
+        uint64_t sent;
+
+        clock_type::time_point stamp;
+    };
+
+    context_t& m_context;
+
     std::unique_ptr<logging::log_t> m_log;
 
     // Connections
 
     std::map<int, std::shared_ptr<session_t>> m_sessions;
+    std::map<int, sample_t> m_samples;
+
+    // Number of sessions attached to this unit, including the ones which are still waiting for the
+    // reactor to pick them up. Updated instantly, unlike the CPU utilization.
+    std::atomic<size_t> m_load;
 
     // I/O
 
@@ -45,21 +73,46 @@ class execution_unit_t {
     std::unique_ptr<io::chamber_t> m_chamber;
 
 public:
-    explicit
-    execution_unit_t(context_t& context);
+    execution_unit_t(context_t& context, const std::vector<unsigned int>& cpus);
 
    ~execution_unit_t();
 
     void
     attach(const std::shared_ptr<asio::ip::tcp::socket>& ptr, const io::dispatch_ptr_t& dispatch);
 
+    // Accepts connections right in this unit's reactor using its own listening socket bound to the
+    // endpoint with SO_REUSEPORT, so that the kernel balances connections across the units with no
+    // socket handoff. The acceptor must be closed on this unit's reactor thread.
+    auto
+    listen(const asio::ip::tcp::endpoint& endpoint, const io::dispatch_ptr_t& dispatch)
+        -> std::shared_ptr<asio::ip::tcp::acceptor>;
+
     double
     utilization() const;
 
+    // Recent mean scheduling lag of the unit's reactor, in microseconds.
+    double
+    lag() const;
+
+    auto
+    affinity() const -> const std::vector<unsigned int>&;
+
+    auto
+    load() const -> size_t;
+
+    // Collects the unit's runtime information on its reactor thread, and passes it to the handler on
+    // the same thread: per-session channel counts, buffered bytes and message rates since the last
+    // inspection, and the scheduling lag of the inspection itself.
+    void
+    inspect(const std::function<void(const dynamic_t&)>& handler);
+
 private:
     void
     attach_impl(const std::shared_ptr<asio::ip::tcp::socket>& ptr, const io::dispatch_ptr_t& dispatch);
 
+    void
+    start(std::unique_ptr<asio::ip::tcp::socket> ptr, const io::dispatch_ptr_t& dispatch);
+
     void
     on_shutdown(const std::error_code& ec, int socket);
 };
@@ -48,6 +48,8 @@ namespace results {
 typedef result_of<io::locator::resolve>::type resolve;
 typedef result_of<io::locator::connect>::type connect;
 typedef result_of<io::locator::cluster>::type cluster;
+typedef result_of<io::locator::metrics>::type metrics;
+typedef result_of<io::locator::runtime>::type runtime;
 
 } // namespace results
 
@@ -144,6 +146,12 @@ private:
     auto
     on_cluster() const -> results::cluster;
 
+    auto
+    on_metrics() -> results::metrics;
+
+    auto
+    on_runtime() const -> deferred<results::runtime>;
+
     // Context signals
 
     void
@@ -28,7 +28,9 @@
 #include "cocaine/dynamic.hpp"
 
 #include "cocaine/detail/service/node/event.hpp"
+#include "cocaine/detail/service/node/ewma.hpp"
 #include "cocaine/detail/service/node/forwards.hpp"
+#include "cocaine/detail/service/node/index.hpp"
 #include "cocaine/detail/service/node/queue.hpp"
 
 #include "cocaine/rpc/asio/encoder.hpp"
@@ -36,6 +38,7 @@
 
 #include <atomic>
 #include <mutex>
+#include <set>
 
 #include <asio/deadline_timer.hpp>
 #include <asio/local/stream_protocol.hpp>
@@ -79,9 +82,33 @@ class engine_t {
     // Session tagging.
     std::atomic<uint64_t> m_next_id;
 
-    // Session queue.
+    // Sessions enqueued by clients from any thread, picked up by the engine thread.
+    mpsc_queue_t<std::shared_ptr<session_t>> m_inbox;
+
+    // Session queue. Only accessed on the engine thread.
     session_queue_t m_queue;
 
+    // Number of sessions both in the inbox and in the queue, checked against the queue limit.
+    std::atomic<size_t> m_queue_depth;
+
+    // Predictive spawning. Untagged sessions are counted as they arrive and periodically sampled
+    // into the arrival rate, which together with the average slave startup time tells how many new
+    // sessions to expect before a slave spawned right now would be able to serve any of them. This
+    // is only accounted while the pool falls behind, i.e. sessions are queued.
+    std::atomic<uint64_t> m_arrivals;
+    uint64_t m_sampled;
+
+    asio::deadline_timer m_sample_timer;
+
+    ewma_t m_rate;
+    ewma_t m_startup;
+
+    // Pool shrinking. The average number of sessions in progress tells whether the pool can do with
+    // one slave less, and only one slave is retired at a time.
+    ewma_t m_busy;
+
+    std::string m_retiring;
+
     // Slave pool.
     typedef std::map<
         int,
@@ -97,9 +124,18 @@ class engine_t {
 
     pool_map_t m_pool;
 
+    // Slaves spawned for tagged sessions. Tagged sessions are assigned to their slave directly, so
+    // these slaves are never retired by the engine, otherwise a session could be assigned to a slave
+    // which is already shutting down.
+    std::set<std::string> m_tagged;
+
     // Spawning mutex.
     std::mutex m_pool_mutex;
 
+    // Slaves ranked by their load for dispatching. Only accessed on the engine thread, so it needs
+    // no locking, and kept up to date by the slaves themselves via update().
+    load_index_t<std::shared_ptr<slave_t>> m_index;
+
     // NOTE: A strong isolate reference, keeping it here
     // avoids isolate destruction, as the factory stores
     // only weak references to the isolate instances.
@@ -153,21 +189,44 @@ private:
     void
     on_termination(const std::error_code& ec);
 
+    void
+    on_sample(const std::error_code& ec);
+
     void
     erase(const std::string& id, int code, const std::string& reason);
 
+    // Called by slaves when their load or state changes. Must be invoked only from engine's thread.
+    void
+    update(const std::shared_ptr<slave_t>& slave);
+
     void
     wake();
 
     void
     do_wake();
 
+    // Moves the sessions from the inbox into the queue. Must be invoked only from engine's thread.
+    void
+    drain();
+
     void
     pump();
 
     void
     balance();
 
+    // Keeps the configured minimum of slaves and the number of idle slaves warm.
+    void
+    warm();
+
+    // Retires one idle slave, if the rest of the pool can cope with the load.
+    void
+    shrink();
+
+    // Grows the pool up to the given target. Must be invoked with the pool mutex held.
+    void
+    spawn(size_t target);
+
     void
     migrate(states target);
 
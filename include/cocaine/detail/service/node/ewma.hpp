@@ -0,0 +1,59 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_ENGINE_EWMA_HPP
+#define COCAINE_ENGINE_EWMA_HPP
+
+#include "cocaine/common.hpp"
+
+namespace cocaine { namespace engine {
+
+// Exponentially weighted moving average. Each new sample contributes the given fraction of itself
+// to the average, so older samples fade out geometrically. The first sample is taken as is.
+
+class ewma_t {
+    const double m_alpha;
+
+    double m_value;
+    bool m_primed;
+
+public:
+    explicit
+    ewma_t(double alpha):
+        m_alpha(alpha),
+        m_value(0),
+        m_primed(false)
+    { }
+
+    void
+    add(double sample) {
+        m_value = m_primed ? m_value + m_alpha * (sample - m_value) : sample;
+        m_primed = true;
+    }
+
+    auto
+    get() const -> double {
+        return m_value;
+    }
+};
+
+}} // namespace cocaine::engine
+
+#endif
@@ -0,0 +1,181 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_ENGINE_INDEX_HPP
+#define COCAINE_ENGINE_INDEX_HPP
+
+#include "cocaine/common.hpp"
+
+#include <map>
+#include <set>
+
+namespace cocaine { namespace engine {
+
+// Entries ranked by their load, with the least loaded available one in front. Entries which can't
+// accept any more work are still tracked, but not ranked. Every operation is O(log N), so there's
+// no need to scan the whole pool on each dispatch. Not synchronized.
+
+template<class T>
+class load_index_t {
+    COCAINE_DECLARE_NONCOPYABLE(load_index_t)
+
+    typedef std::pair<size_t, T> rank_type;
+
+    // Available entries ordered by load.
+    std::set<rank_type> m_ranks;
+
+    // Last known load of every entry.
+    std::map<T, size_t> m_loads;
+
+    // Number of available entries with no load at all.
+    size_t m_idle;
+
+    // Sum of the loads of all the entries.
+    size_t m_total;
+
+    void
+    rank(const rank_type& entry);
+
+    void
+    unrank(const rank_type& entry);
+
+public:
+    load_index_t():
+        m_idle(0),
+        m_total(0)
+    { }
+
+    // Inserts a new entry or updates the known one.
+    void
+    update(const T& key, size_t load, bool available);
+
+    void
+    erase(const T& key);
+
+    void
+    clear();
+
+    // Fetches the least loaded available entry, returns false if there are none.
+    bool
+    top(T& key) const;
+
+    auto
+    count(const T& key) const -> size_t {
+        return m_loads.count(key);
+    }
+
+    auto
+    size() const -> size_t {
+        return m_loads.size();
+    }
+
+    // Number of entries which can accept more work.
+    auto
+    available() const -> size_t {
+        return m_ranks.size();
+    }
+
+    // Number of available entries which have no work at all.
+    auto
+    idle() const -> size_t {
+        return m_idle;
+    }
+
+    auto
+    total() const -> size_t {
+        return m_total;
+    }
+};
+
+template<class T>
+void
+load_index_t<T>::rank(const rank_type& entry) {
+    if(m_ranks.insert(entry).second && entry.first == 0) {
+        m_idle++;
+    }
+}
+
+template<class T>
+void
+load_index_t<T>::unrank(const rank_type& entry) {
+    if(m_ranks.erase(entry) && entry.first == 0) {
+        m_idle--;
+    }
+}
+
+template<class T>
+void
+load_index_t<T>::update(const T& key, size_t load, bool available) {
+    auto it = m_loads.find(key);
+
+    if(it == m_loads.end()) {
+        it = m_loads.insert(std::make_pair(key, load)).first;
+    } else {
+        unrank(rank_type(it->second, key));
+        m_total -= it->second;
+        it->second = load;
+    }
+
+    m_total += load;
+
+    if(available) {
+        rank(rank_type(load, key));
+    }
+}
+
+template<class T>
+void
+load_index_t<T>::erase(const T& key) {
+    auto it = m_loads.find(key);
+
+    if(it == m_loads.end()) {
+        return;
+    }
+
+    unrank(rank_type(it->second, key));
+    m_total -= it->second;
+    m_loads.erase(it);
+}
+
+template<class T>
+void
+load_index_t<T>::clear() {
+    m_ranks.clear();
+    m_loads.clear();
+
+    m_idle  = 0;
+    m_total = 0;
+}
+
+template<class T>
+bool
+load_index_t<T>::top(T& key) const {
+    if(m_ranks.empty()) {
+        return false;
+    }
+
+    key = m_ranks.begin()->second;
+
+    return true;
+}
+
+}} // namespace cocaine::engine
+
+#endif
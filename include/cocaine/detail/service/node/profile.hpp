@@ -52,6 +52,13 @@ struct profile_t:
     unsigned long pool_limit;
     unsigned long queue_limit;
 
+    // Number of idle slaves to keep started in advance, so that bursts don't wait for spawning.
+    unsigned long warm_pool;
+
+    // The engine never shrinks the pool below this size. Above it, slaves which have been idle for
+    // longer than the idle timeout are retired one at a time, while the rest of the pool can cope.
+    unsigned long pool_minimum;
+
     // NOTE: The slave processes are launched in sandboxed environments,
     // called isolates. This one describes the isolate type and arguments.
     config_t::component_t isolate;
@@ -21,34 +21,93 @@
 #ifndef COCAINE_ENGINE_QUEUE_HPP
 #define COCAINE_ENGINE_QUEUE_HPP
 
+#include "cocaine/common.hpp"
+
+#include <atomic>
 #include <deque>
 #include <memory>
-#include <mutex>
 
 namespace cocaine { namespace engine {
 
 struct session_t;
 
+// Session queue with urgent sessions placed in front. Not synchronized.
+
 struct session_queue_t:
     public std::deque<std::shared_ptr<session_t>>
 {
     void
     push(const_reference session);
+};
 
-    // Lockable concept implementation
+// Unbounded lock-free multiple producers single consumer queue. Pushing is wait-free, a single XCHG
+// instruction, so producers never block each other nor the consumer. Any number of threads can push
+// concurrently, but only one thread at a time can pop.
+//
+// NOTE: A pop might fail while another push is still in progress, even if there are elements pushed
+// after it. Producers are expected to notify the consumer after pushing, so it's never a problem.
 
-    void
-    lock() {
-        m_mutex.lock();
+template<class T>
+class mpsc_queue_t {
+    COCAINE_DECLARE_NONCOPYABLE(mpsc_queue_t)
+
+    struct node_t {
+        std::atomic<node_t*> next;
+        T value;
+    };
+
+    // Producers append nodes to the head.
+    std::atomic<node_t*> m_head;
+
+    // The consumer pops nodes from the tail. The tail node is always a stub, which value has been
+    // already popped.
+    node_t* m_tail;
+
+public:
+    mpsc_queue_t():
+        m_tail(new node_t())
+    {
+        m_tail->next = nullptr;
+        m_head = m_tail;
+    }
+
+   ~mpsc_queue_t() {
+        while(node_t* node = m_tail) {
+            m_tail = node->next;
+            delete node;
+        }
     }
 
     void
-    unlock() {
-        m_mutex.unlock();
+    push(const T& value) {
+        node_t* node = new node_t();
+
+        node->next  = nullptr;
+        node->value = value;
+
+        // Publish the node: after the exchange, the node is reachable from the previous head only
+        // when its link is stored, which happens right away.
+        m_head.exchange(node, std::memory_order_acq_rel)->next.store(node, std::memory_order_release);
     }
 
-private:
-    std::mutex m_mutex;
+    bool
+    pop(T& value) {
+        node_t* tail = m_tail;
+        node_t* next = tail->next.load(std::memory_order_acquire);
+
+        if(next == nullptr) {
+            return false;
+        }
+
+        value = std::move(next->value);
+
+        // The popped node becomes the new stub.
+        m_tail = next;
+
+        delete tail;
+
+        return true;
+    }
 };
 
 }} // namespace cocaine::engine
@@ -56,6 +56,10 @@ struct session_t:
         void
         write(const char* chunk, size_t size);
 
+        virtual
+        void
+        write(const char* chunk, size_t size, const std::shared_ptr<const void>& owner);
+
         virtual
         void
         error(int code, const std::string& reason);
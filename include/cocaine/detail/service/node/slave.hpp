@@ -67,7 +67,7 @@ class slave_t : public std::enable_shared_from_this<slave_t> {
     const std::string m_id;
 
     // Self engine-control.
-    typedef std::function<void()> rebalance_type;
+    typedef std::function<void(const std::shared_ptr<slave_t>&)> rebalance_type;
     typedef std::function<void(const std::string&, int, const std::string&)> suicide_type;
     rebalance_type m_rebalance;
     suicide_type m_suicide;
@@ -76,18 +76,32 @@ class slave_t : public std::enable_shared_from_this<slave_t> {
     states m_state;
 
 #ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
-    const std::chrono::steady_clock::time_point m_birthstamp;
+    typedef std::chrono::steady_clock clock_type;
 #else
-    const std::chrono::monotonic_clock::time_point m_birthstamp;
+    typedef std::chrono::monotonic_clock clock_type;
 #endif
 
+    const clock_type::time_point m_birthstamp;
+
+    // Time it took the slave to become active, in seconds.
+    float m_startup;
+
+    // Time point when the slave has run out of sessions.
+    clock_type::time_point m_idlestamp;
+
+    // Number of sessions the slave has started processing.
+    size_t m_served;
+
     asio::deadline_timer m_heartbeat_timer;
-    asio::deadline_timer m_idle_timer;
 
     // IO communication with worker.
     io::decoder_t::message_type m_message;
     std::shared_ptr<io::channel<protocol_type>> m_channel;
 
+    // The client stream which has been blocked by the last chunk forwarded to it. Reading from the
+    // worker is paused until the stream catches up.
+    std::shared_ptr<api::stream_t> m_throttled;
+
     // Active sessions (or channels now?).
     typedef std::map<
         uint64_t,
@@ -116,7 +130,7 @@ public:
     void
     bind(const std::shared_ptr<io::channel<protocol_type>>& channel);
 
-    // Session scheduling.
+    // Session scheduling. Invoked from the engine's thread, it takes effect immediately.
     void
     assign(const std::shared_ptr<session_t>& session);
 
@@ -135,6 +149,28 @@ public:
         return m_sessions.size();
     }
 
+    float
+    startup() const {
+        return m_startup;
+    }
+
+    size_t
+    served() const {
+        return m_served;
+    }
+
+    // Seconds since the slave has been spawned.
+    float
+    uptime() const;
+
+    // Seconds since the slave has run out of sessions, zero if it's still busy or not active yet.
+    float
+    idle() const;
+
+    // Asks the worker to shut down gracefully. Only idle active slaves can be retired.
+    void
+    retire();
+
 private:
     void
     do_assign(std::shared_ptr<session_t> session);
@@ -146,10 +182,18 @@ private:
     void
     activate();
 
+    // Reads the next message from the worker.
+    void
+    pull();
+
     // Called on any read event from the worker.
     void
     on_read(const std::error_code& ec);
 
+    // Called on any thread once the throttled client stream has caught up.
+    void
+    on_resume();
+
     // Called on any write event to the worker.
     void
     on_write(const std::error_code& ec);
@@ -176,7 +220,7 @@ private:
 
     // Chunk handler.
     void
-    on_chunk(uint64_t session_id, const std::string& chunk);
+    on_chunk(uint64_t session_id, const io::slice_t& chunk);
 
     // Error handler.
     void
@@ -190,10 +234,6 @@ private:
     void
     on_timeout(const std::error_code& ec);
 
-    // Called on idle timeout.
-    void
-    on_idle(const std::error_code& ec);
-
     // Housekeeping.
     void
     pump();
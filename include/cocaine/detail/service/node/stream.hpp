@@ -23,6 +23,8 @@
 
 #include "cocaine/common.hpp"
 
+#include <functional>
+
 namespace cocaine { namespace api {
 
 struct stream_t {
@@ -35,6 +37,14 @@ struct stream_t {
     void
     write(const char* chunk, size_t size) = 0;
 
+    // Writes a chunk which is kept alive by its owner, so that the stream could hold on to it instead
+    // of making a copy. By default, the chunk is copied as usual.
+    virtual
+    void
+    write(const char* chunk, size_t size, const std::shared_ptr<const void>& COCAINE_UNUSED_(owner)) {
+        write(chunk, size);
+    }
+
     virtual
     void
     error(int code, const std::string& reason) = 0;
@@ -42,6 +52,21 @@ struct stream_t {
     virtual
     void
     close() = 0;
+
+    // Flow control. Whether the consumer doesn't keep up with the chunks written so far, so that the
+    // producer should hold off until the handler passed to await() is called. By default, streams
+    // never block.
+    virtual
+    bool
+    would_block() const {
+        return false;
+    }
+
+    virtual
+    void
+    await(const std::function<void()>& handler) {
+        handler();
+    }
 };
 
 typedef std::shared_ptr<stream_t> stream_ptr_t;
@@ -53,6 +78,10 @@ struct null_stream_t:
     void
     write(const char*, size_t) { }
 
+    virtual
+    void
+    write(const char*, size_t, const std::shared_ptr<const void>&) { }
+
     virtual
     void
     error(int, const std::string&) { }
@@ -25,18 +25,29 @@
 
 #include "cocaine/idl/storage.hpp"
 #include "cocaine/rpc/dispatch.hpp"
+#include "cocaine/rpc/offload.hpp"
 
 namespace cocaine { namespace service {
 
-struct storage_t:
+class storage_t:
     public api::service_t,
     public dispatch<io::storage_tag>
 {
+    // Worker pool for the storage backend calls.
+    std::shared_ptr<io::offload_pool_t> m_pool;
+
+public:
     storage_t(context_t& context, asio::io_service& asio, const std::string& name, const dynamic_t& args);
 
     virtual
     auto
     prototype() const -> const io::basic_dispatch_t&;
+
+    // Reports the offload pool queue depth and per-slot queueing and execution latencies along with
+    // the regular invocation metrics.
+    virtual
+    auto
+    metrics() const -> dynamic_t;
 };
 
 }} // namespace cocaine::service
@@ -52,6 +52,11 @@ public:
     write(const std::string& collection, const std::string& key, const std::string& blob,
           const std::vector<std::string>& tags);
 
+    virtual
+    void
+    write(const std::string& collection, const std::string& key, const char* blob, size_t size,
+          const std::vector<std::string>& tags);
+
     virtual
     void
     remove(const std::string& collection, const std::string& key);
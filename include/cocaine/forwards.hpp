@@ -60,6 +60,8 @@ class readable_stream;
 template<class, class>
 class writable_stream;
 
+struct write_stats_t;
+
 // Stream composition
 
 template<class>
@@ -21,6 +21,8 @@
 #ifndef COCAINE_SERVICE_LOCATOR_INTERFACE_HPP
 #define COCAINE_SERVICE_LOCATOR_INTERFACE_HPP
 
+#include "cocaine/dynamic.hpp"
+
 #include "cocaine/idl/primitive.hpp"
 
 #include "cocaine/rpc/graph.hpp"
@@ -110,6 +112,35 @@ struct cluster {
     >::tag upstream_type;
 };
 
+struct metrics {
+    typedef locator_tag tag;
+
+    static const char* alias() {
+        return "metrics";
+    }
+
+    typedef option_of<
+     /* Invocation counters and latency histograms of every slot of every local service, keyed by
+        service and message names. Empty, unless the instrumentation is enabled in the config.
+        Services with offload pools also report their queue depths and latencies as "offload". */
+        dynamic_t
+    >::tag upstream_type;
+};
+
+struct runtime {
+    typedef locator_tag tag;
+
+    static const char* alias() {
+        return "runtime";
+    }
+
+    typedef option_of<
+     /* Runtime information of every execution unit: its sessions with their channel counts, bytes
+        buffered in the read and write rings and message rates, and the unit's scheduling lag. */
+        dynamic_t
+    >::tag upstream_type;
+};
+
 }; // struct locator
 
 template<>
@@ -122,7 +153,9 @@ struct protocol<locator_tag> {
         locator::resolve,
         locator::connect,
         locator::refresh,
-        locator::cluster
+        locator::cluster,
+        locator::metrics,
+        locator::runtime
     > messages;
 
     typedef locator scope;
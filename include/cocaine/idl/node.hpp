@@ -37,8 +37,9 @@ struct enqueue {
     typedef app_tag tag;
 
     typedef stream_of<
-     /* Allow clients to stream data into the apps. */
-        std::string
+     /* Allow clients to stream data into the apps. Chunks are forwarded right from the receive
+        buffer, without being copied out of it first. */
+        view<std::string>
     >::tag dispatch_type;
 
     static const char* alias() {
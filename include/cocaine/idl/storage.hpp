@@ -66,8 +66,8 @@ struct write {
      /* Key. */
         std::string,
      /* Value. Typically, it should be serialized with msgpack, so that the future reader could
-        assume that it can be deserialized safely. */
-        std::string,
+        assume that it can be deserialized safely. Consumed right from the receive buffer. */
+        view<std::string>,
      /* Tag list. Imagine these are your indexes. */
         optional<std::vector<std::string>>
     > argument_type;
@@ -29,11 +29,88 @@ namespace cocaine { namespace io {
 
 struct decoder_t;
 
+template<class, class>
+class readable_stream;
+
+namespace aux {
+
+struct decoded_message_t;
+
+} // namespace aux
+
+// Reference-counted view into a receive buffer segment. As long as the slice is alive, the segment
+// it points to won't be reused or moved by the stream, so the payload bytes might be handed over to
+// the consumer without copying them out of the stream buffer first.
+
+struct slice_t {
+    friend struct aux::decoded_message_t;
+
+    slice_t():
+        blob(nullptr),
+        size(0)
+    { }
+
+    slice_t(const std::shared_ptr<const void>& segment_, const char* blob_, size_t size_):
+        blob(blob_),
+        size(size_),
+        segment(segment_)
+    { }
+
+    operator std::string() const {
+        return std::string(blob, size);
+    }
+
+    // Might be used as an owner for literal_t to forward the slice without copying it.
+    auto
+    owner() const -> const std::shared_ptr<const void>& {
+        return segment;
+    }
+
+    const char * blob;
+    size_t       size;
+
+private:
+    std::shared_ptr<const void> segment;
+};
+
+// Slices are unpacked by reference, the segment is pinned afterwards by the message which they have
+// been unpacked from, see decoded_message_t::pin().
+
+template<>
+struct type_traits<slice_t> {
+    template<class Stream>
+    static inline
+    void
+    pack(msgpack::packer<Stream>& target, const slice_t& source) {
+        target.pack_raw(source.size);
+        target.pack_raw_body(source.blob, source.size);
+    }
+
+    static inline
+    void
+    unpack(const msgpack::object& source, slice_t& target) {
+        if(source.type != msgpack::type::RAW) {
+            throw msgpack::type_error();
+        }
+
+        target.blob = source.via.raw.ptr;
+        target.size = source.via.raw.size;
+    }
+};
+
 namespace aux {
 
 struct decoded_message_t {
     friend struct io::decoder_t;
 
+    template<class, class>
+    friend class io::readable_stream;
+
+    decoded_message_t():
+        capacity(0),
+        length(0)
+    { }
+
     auto
     span() const -> uint64_t {
         return object.via.array.ptr[0].as<uint64_t>();
@@ -49,8 +126,56 @@ struct decoded_message_t {
         return object.via.array.ptr[2];
     }
 
+    // Size of the encoded message frame.
+    auto
+    size() const -> size_t {
+        return length;
+    }
+
+    // Returns a view of the given raw object, which must be a part of this message, see pin().
+    auto
+    slice(const msgpack::object& raw) const -> slice_t {
+        if(raw.type != msgpack::type::RAW) {
+            throw msgpack::type_error();
+        }
+
+        slice_t result(nullptr, raw.via.raw.ptr, raw.via.raw.size);
+
+        pin(result);
+
+        return result;
+    }
+
+    // Pins the buffer segment for a slice which has been unpacked from this message's arguments.
+    // Slices smaller than a fraction of the segment are copied out instead, so that a slice kept
+    // alive for long doesn't hold the whole segment, which might be many times larger than itself.
+    void
+    pin(slice_t& target) const {
+        if(target.size * kMaxPinRatio >= capacity) {
+            target.segment = segment;
+            return;
+        }
+
+        const auto copy = std::make_shared<std::string>(target.blob, target.size);
+
+        target.blob    = copy->data();
+        target.segment = copy;
+    }
+
 private:
+    // Slices are pinned only if the segment is at most this many times larger than the slice.
+    enum constants { kMaxPinRatio = 4 };
+
     msgpack::object object;
+
+    // NOTE: Raw objects reference the stream buffer directly instead of being copied into the zone,
+    // so this is what keeps them valid after the stream has moved on to the next message.
+    std::shared_ptr<const void> segment;
+
+    // Size of the pinned segment in bytes.
+    size_t capacity;
+
+    size_t length;
 };
 
 } // namespace aux
@@ -67,8 +192,14 @@ struct decoder_t {
     decode(const char* data, size_t size, message_type& message, std::error_code& ec) {
         size_t offset = 0;
 
+        // Objects from the previous message are not referenced by anyone at this point, only its raw
+        // bytes might be, and those live in the stream buffer, not in the zone.
+        zone.clear();
+
         msgpack::unpack_return rv = msgpack::unpack(data, size, &offset, &zone, &message.object);
 
+        message.length = offset;
+
         if(rv == msgpack::UNPACK_SUCCESS || rv == msgpack::UNPACK_EXTRA_BYTES) {
             if(message.object.type != msgpack::type::ARRAY || message.object.via.array.size < 3) {
                 ec = error::frame_format_error;
@@ -26,13 +26,19 @@
 #include "cocaine/traits.hpp"
 #include "cocaine/traits/tuple.hpp"
 
+#include "cocaine/utility.hpp"
+
 #include <cstring>
+#include <vector>
 
 namespace cocaine { namespace io {
 
 template<class Event>
 struct encoded;
 
+template<class Event>
+class preencoded;
+
 struct encoder_t;
 
 namespace aux {
@@ -42,35 +48,145 @@ struct encoded_buffers_t {
 
     static const size_t kInitialBufferSize = 2048;
 
+    // Payloads smaller than this are always copied, as it's cheaper than an extra iovec.
+    static const size_t kAttachThreshold = 4096;
+
     encoded_buffers_t():
-        offset(0)
-    {
-        vector.resize(kInitialBufferSize);
-    }
+        blob(nullptr),
+        capacity(0),
+        offset(0),
+        attached(0)
+    { }
+
+   ~encoded_buffers_t();
 
     void
     write(const char* data, size_t size) {
-        while(size > vector.size() - offset) {
-            vector.resize(vector.size() * 2);
+        if(size > capacity - offset) {
+            reserve(offset + size);
         }
 
-        std::memcpy(vector.data() + offset, data, size);
+        std::memcpy(blob + offset, data, size);
 
         offset += size;
     }
 
+    // Makes sure that the buffer can hold at least the specified number of bytes. Buffers are taken
+    // from a thread-local pool of power-of-two size classes and returned back to the pool of the
+    // thread which destroys them, so steady-state encoding doesn't hit the allocator at all.
+    void
+    reserve(size_t size);
+
+    // Appends the payload by reference instead of copying it. The owner is kept alive until the
+    // message is destroyed, i.e. until it's completely written.
+    void
+    attach(const char* data, size_t size, const std::shared_ptr<const void>& owner) {
+        segments.push_back(segment_t{offset, data, size, owner});
+        attached += size;
+    }
+
     // Movable
 
-    encoded_buffers_t(encoded_buffers_t&&) = default;
+    encoded_buffers_t(encoded_buffers_t&& other);
 
     encoded_buffers_t&
-    operator=(encoded_buffers_t&&) = default;
+    operator=(encoded_buffers_t&& other);
 
     COCAINE_DECLARE_NONCOPYABLE(encoded_buffers_t)
 
 private:
-    std::vector<char, uninitialized<char>> vector;
-    std::vector<char, uninitialized<char>>::size_type offset;
+    struct segment_t {
+        // Position of this segment in the encoded byte stream.
+        size_t offset;
+
+        const char * data;
+        size_t size;
+
+        std::shared_ptr<const void> owner;
+    };
+
+    char * blob;
+    size_t capacity;
+    size_t offset;
+
+    // Attached payload segments, ordered by their positions, and their total size.
+    std::vector<segment_t> segments;
+    size_t attached;
+};
+
+// Packer which exposes its underlying buffer, so that type traits could attach large payloads to
+// messages being encoded. All the packers for encoding buffers are instances of this class.
+
+struct encoded_packer_t:
+    public msgpack::packer<encoded_buffers_t>
+{
+    explicit
+    encoded_packer_t(encoded_buffers_t& buffer_):
+        msgpack::packer<encoded_buffers_t>(buffer_),
+        buffer(buffer_)
+    { }
+
+    encoded_buffers_t& buffer;
+};
+
+inline
+size_t
+estimate() {
+    return 0;
+}
+
+template<class Head, class... Tail>
+inline
+size_t
+estimate(const Head& head, const Tail&... tail) {
+    return size_traits<Head>::estimate(head) + estimate(tail...);
+}
+
+// Message arguments are either packed right into the message buffer, or, if they've been encoded
+// beforehand, the encoded payload is appended by reference.
+
+template<class Event, class... Args>
+struct payload_traits {
+    template<typename... T>
+    static inline
+    size_t
+    estimate(const T&... args) {
+        return aux::estimate(args...);
+    }
+
+    template<typename... T>
+    static inline
+    void
+    pack(encoded_packer_t& packer, T&&... args) {
+        typedef typename event_traits<Event>::argument_type argument_type;
+
+        type_traits<argument_type>::pack(packer, std::forward<T>(args)...);
+    }
+};
+
+template<class Event>
+struct payload_traits<Event, preencoded<Event>> {
+    static inline
+    size_t
+    estimate(const preencoded<Event>& payload) {
+        return attachable(payload) ? 0 : payload.size();
+    }
+
+    static inline
+    void
+    pack(encoded_packer_t& packer, const preencoded<Event>& payload) {
+        if(attachable(payload)) {
+            packer.buffer.attach(payload.data(), payload.size(), payload.owner());
+        } else {
+            packer.buffer.write(payload.data(), payload.size());
+        }
+    }
+
+    static inline
+    bool
+    attachable(const preencoded<Event>& payload) {
+        return payload.size() >= encoded_buffers_t::kAttachThreshold;
+    }
 };
 
 struct encoded_message_t {
@@ -79,20 +195,100 @@ struct encoded_message_t {
     template<class>
     friend struct io::encoded;
 
+    encoded_message_t():
+        messages(0)
+    { }
+
+    // Movable
+
+    encoded_message_t(encoded_message_t&& other):
+        buffer(std::move(other.buffer)),
+        messages(other.messages)
+    {
+        other.messages = 0;
+    }
+
+    encoded_message_t&
+    operator=(encoded_message_t&& other) {
+        buffer   = std::move(other.buffer);
+        messages = other.messages;
+
+        other.messages = 0;
+
+        return *this;
+    }
+
+    // The message is a sequence of contiguous chunks: encoded bytes interleaved with the attached
+    // payload segments. Some of the encoded chunks might be empty.
+
+    size_t
+    chunks() const {
+        return buffer.segments.size() * 2 + 1;
+    }
+
     auto
-    data() const -> const char* {
-        return buffer.vector.data();
+    chunk(size_t n) const -> std::pair<const char*, size_t> {
+        const auto& segments = buffer.segments;
+
+        if(n % 2) {
+            return std::make_pair(segments[n / 2].data, segments[n / 2].size);
+        }
+
+        const size_t lower = n ? segments[n / 2 - 1].offset : 0;
+        const size_t upper = n / 2 < segments.size() ? segments[n / 2].offset : buffer.offset;
+
+        return std::make_pair(buffer.blob + lower, upper - lower);
     }
 
     size_t
     size() const {
-        return buffer.offset;
+        return buffer.offset + buffer.attached;
+    }
+
+    bool
+    empty() const {
+        return size() == 0;
+    }
+
+    // Number of messages encoded into this buffer.
+    size_t
+    count() const {
+        return messages;
     }
 
+    // Encodes one more message right after the ones already in the buffer, so that a number of
+    // messages could be handed over to the transport as a single contiguous write.
+    template<class Event, typename... Args>
+    void
+    append(uint64_t span, Args&&... args);
+
 private:
+    // Array tag and two integers.
+    static const size_t kHeaderSize = 19;
+
     encoded_buffers_t buffer;
+    size_t messages;
 };
 
+template<class Event, typename... Args>
+void
+encoded_message_t::append(uint64_t span, Args&&... args) {
+    typedef payload_traits<Event, typename pristine<Args>::type...> traits_type;
+
+    buffer.reserve(buffer.offset + kHeaderSize + traits_type::estimate(args...));
+
+    encoded_packer_t packer(buffer);
+
+    packer.pack_array(3);
+
+    packer.pack(span);
+    packer.pack(static_cast<uint64_t>(event_traits<Event>::id));
+
+    traits_type::pack(packer, std::forward<Args>(args)...);
+
+    messages++;
+}
+
 } // namespace aux
 
 template<class Event>
@@ -101,19 +297,60 @@ struct encoded:
 {
     template<typename... Args>
     encoded(uint64_t span, Args&&... args) {
-        msgpack::packer<aux::encoded_buffers_t> packer(buffer);
+        append<Event>(span, std::forward<Args>(args)...);
+    }
+};
 
-        packer.pack_array(3);
+// Message arguments encoded once to be sent to any number of channels. Only the message header is
+// encoded for every channel, while the payload is shared between all the messages, so broadcasting
+// a message doesn't repack it over and over again. Preencoded payloads are immutable.
 
-        packer.pack(span);
-        packer.pack(static_cast<uint64_t>(event_traits<Event>::id));
+template<class Event>
+class preencoded {
+    std::shared_ptr<const std::string> m_payload;
 
-        typedef typename event_traits<Event>::argument_type argument_type;
+public:
+    preencoded() = default;
 
-        type_traits<argument_type>::pack(packer, std::forward<Args>(args)...);
+    explicit
+    preencoded(const std::shared_ptr<const std::string>& payload):
+        m_payload(payload)
+    { }
+
+    const char*
+    data() const {
+        return m_payload->data();
+    }
+
+    size_t
+    size() const {
+        return m_payload->size();
+    }
+
+    auto
+    owner() const -> std::shared_ptr<const void> {
+        return m_payload;
+    }
+
+    bool
+    empty() const {
+        return !m_payload;
     }
 };
 
+template<class Event, typename... Args>
+preencoded<Event>
+make_preencoded(Args&&... args) {
+    typedef typename event_traits<Event>::argument_type argument_type;
+
+    msgpack::sbuffer buffer;
+    msgpack::packer<msgpack::sbuffer> packer(buffer);
+
+    type_traits<argument_type>::pack(packer, std::forward<Args>(args)...);
+
+    return preencoded<Event>(std::make_shared<std::string>(buffer.data(), buffer.size()));
+}
+
 struct encoder_t {
     typedef aux::encoded_message_t message_type;
 };
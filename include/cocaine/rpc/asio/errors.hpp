@@ -26,7 +26,8 @@ namespace cocaine { namespace error {
 enum decode_errors {
     parse_error = 1,
     frame_format_error,
-    insufficient_bytes
+    insufficient_bytes,
+    frame_too_large
 };
 
 namespace aux {
@@ -52,6 +53,9 @@ class decode_category_t:
 
           case decode_errors::insufficient_bytes:
             return "insufficient bytes provided to decode the message";
+
+          case decode_errors::frame_too_large:
+            return "message doesn't fit into the receive buffer";
         }
 
         return "cocaine.rpc.asio error";
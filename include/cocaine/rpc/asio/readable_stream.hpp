@@ -28,7 +28,9 @@
 #include <asio/io_service.hpp>
 #include <asio/basic_stream_socket.hpp>
 
+#include <algorithm>
 #include <cstring>
+#include <limits>
 
 namespace cocaine { namespace io {
 
@@ -40,8 +42,6 @@ class readable_stream:
 {
     COCAINE_DECLARE_NONCOPYABLE(readable_stream)
 
-    static const size_t kInitialBufferSize = 65536;
-
     typedef typename Protocol::socket channel_type;
 
     typedef Decoder decoder_type;
@@ -51,59 +51,122 @@ class readable_stream:
 
     typedef std::function<void(const std::error_code&)> handler_type;
 
-    std::vector<char, uninitialized<char>> m_ring;
-    std::vector<char, uninitialized<char>>::size_type m_rd_offset, m_rx_offset;
+    typedef std::vector<char, uninitialized<char>> ring_type;
+
+    // The ring is shared with the decoded messages, so that their payloads could be sliced out of it
+    // without copying. A ring which is still referenced by some slices is never moved or compacted,
+    // a new one is allocated instead and the old one is released along with its last slice.
+    std::shared_ptr<ring_type> m_ring;
+    ring_type::size_type m_rd_offset, m_rx_offset;
+
+    // The ring starts with the initial size, doubles when needed up to the maximum size, and shrinks
+    // back to the initial size once it's drained and the peer has nothing more to send for now.
+    size_t m_initial_size;
+    size_t m_maximum_size;
 
     decoder_type m_decoder;
 
 public:
+    static const size_t kInitialBufferSize = 65536;
+
     explicit
     readable_stream(const std::shared_ptr<channel_type>& channel):
-        m_channel(channel)
+        m_channel(channel),
+        m_ring(std::make_shared<ring_type>(kInitialBufferSize)),
+        m_initial_size(kInitialBufferSize),
+        m_maximum_size(std::numeric_limits<size_t>::max())
     {
-        m_ring.resize(kInitialBufferSize);
         m_rd_offset = m_rx_offset = 0;
     }
 
+    // Sets the ring size limits. Zero maximum size means no limit. Must be called before reading.
+    void
+    bounds(size_t initial_size, size_t maximum_size) {
+        m_initial_size = initial_size;
+        m_maximum_size = maximum_size ? std::max(initial_size, maximum_size) : std::numeric_limits<size_t>::max();
+
+        if(m_ring->size() != m_initial_size && m_rd_offset == 0) {
+            m_ring = std::make_shared<ring_type>(m_initial_size);
+        }
+    }
+
     void
     read(message_type& message, handler_type handle) {
         std::error_code ec;
 
+        // The previous message has been processed by now, so it doesn't need the ring anymore. Only
+        // the slices which were explicitly taken out of it might still keep the ring pinned.
+        message.segment  = nullptr;
+        message.capacity = 0;
+
         const size_t
             bytes_pending = m_rd_offset - m_rx_offset,
-            bytes_decoded = m_decoder.decode(m_ring.data() + m_rx_offset, bytes_pending, message, ec);
+            bytes_decoded = m_decoder.decode(m_ring->data() + m_rx_offset, bytes_pending, message, ec);
 
         if(ec != error::insufficient_bytes) {
             if(!ec) {
                 m_rx_offset += bytes_decoded;
+
+                // Pin the ring, so that the message's raw objects stay valid as long as needed.
+                message.segment  = m_ring;
+                message.capacity = m_ring->size();
             }
 
             return m_channel->get_io_service().post(std::bind(handle, ec));
         }
 
-        if(m_rx_offset) {
-            // Compactify the ring before the asynchronous read operation.
-            std::memmove(m_ring.data(), m_ring.data() + m_rx_offset, bytes_pending);
+        if(m_rx_offset == m_rd_offset && m_ring.unique()) {
+            // Everything has been consumed, so rewind the ring for free.
+            m_rd_offset = m_rx_offset = 0;
 
-            m_rd_offset = bytes_pending;
-            m_rx_offset = 0;
+            if(m_ring->size() > m_initial_size) {
+                // The ring has grown to fit some larger messages. Check whether the peer has some
+                // more data right away, and if it doesn't, shrink the ring back while it's idle.
+                const size_t bytes_read = m_channel->read_some(
+                    asio::buffer(m_ring->data(), m_ring->size()),
+                    ec
+                );
+
+                if(!ec) {
+                    m_rd_offset = bytes_read;
+                    return read(message, handle);
+                }
+
+                if(ec != asio::error::would_block && ec != asio::error::try_again) {
+                    return m_channel->get_io_service().post(std::bind(handle, ec));
+                }
+
+                m_ring = std::make_shared<ring_type>(m_initial_size);
+            }
         }
 
-        if(bytes_pending * 2 >= m_ring.size()) {
-            // The total size of unprocessed data in larger than half the size of the ring, so grow
-            // the ring in order to accomodate more data.
-            m_ring.resize(m_ring.size() * 2);
+        if(m_rd_offset * 2 >= m_ring->size()) {
+            // Less than a half of the ring is left for the incoming data, so it's time to either
+            // compactify or grow the ring. This happens once in a while instead of moving the pending
+            // bytes to the front of the ring on every partial read.
+            relocate(bytes_pending);
+        }
+
+        if(m_rd_offset == m_ring->size()) {
+            // The ring is already at its maximum size and it's full of a single incomplete message.
+            return m_channel->get_io_service().post(std::bind(handle, error::frame_too_large));
         }
 
         m_channel->async_read_some(
-            asio::buffer(m_ring.data() + m_rd_offset, m_ring.size() - m_rd_offset),
+            asio::buffer(m_ring->data() + m_rd_offset, m_ring->size() - m_rd_offset),
             std::bind(&readable_stream::fill, this->shared_from_this(), std::ref(message), handle, ph::_1, ph::_2)
         );
     }
 
+    // Number of received bytes which are not yet decoded.
     auto
     pressure() const -> size_t {
-        return m_ring.size();
+        return m_rd_offset - m_rx_offset;
+    }
+
+    auto
+    capacity() const -> size_t {
+        return m_ring->size();
     }
 
 private:
@@ -121,8 +184,39 @@ private:
 
         read(std::ref(message), handle);
     }
+
+    void
+    relocate(size_t bytes_pending) {
+        // The total size of unprocessed data in larger than half the size of the ring, so grow the
+        // ring in order to accomodate more data.
+        const size_t target = bytes_pending * 2 >= m_ring->size() ?
+            std::min(m_ring->size() * 2, std::max(m_ring->size(), m_maximum_size)) :
+            m_ring->size();
+
+        if(m_ring.unique()) {
+            if(m_rx_offset) {
+                std::memmove(m_ring->data(), m_ring->data() + m_rx_offset, bytes_pending);
+            }
+
+            m_ring->resize(target);
+        } else {
+            // Some slices still reference the ring, so leave it to them and start over with a fresh
+            // one. Only the pending bytes of the current incomplete message are copied.
+            auto ring = std::make_shared<ring_type>(target);
+
+            std::memcpy(ring->data(), m_ring->data() + m_rx_offset, bytes_pending);
+
+            m_ring = std::move(ring);
+        }
+
+        m_rd_offset = bytes_pending;
+        m_rx_offset = 0;
+    }
 };
 
+template<class Protocol, class Decoder>
+const size_t readable_stream<Protocol, Decoder>::kInitialBufferSize;
+
 }} // namespace cocaine::io
 
 #endif
@@ -23,17 +23,30 @@
 
 #include "cocaine/rpc/asio/errors.hpp"
 
+#include <atomic>
 #include <functional>
+#include <limits>
+#include <tuple>
 
 #include <asio/io_service.hpp>
 #include <asio/basic_stream_socket.hpp>
 
 #include <deque>
+#include <vector>
 
 namespace cocaine { namespace io {
 
 namespace ph = std::placeholders;
 
+struct write_stats_t {
+    // Number of messages fully written to the socket.
+    uint64_t messages;
+
+    // Number of write syscalls it took. The difference between the two is the number of syscalls
+    // saved by coalescing multiple messages into a single gather write.
+    uint64_t syscalls;
+};
+
 template<class Protocol, class Encoder>
 class writable_stream:
     public std::enable_shared_from_this<writable_stream<Protocol, Encoder>>
@@ -49,101 +62,236 @@ class writable_stream:
 
     typedef std::function<void(const std::error_code&)> handler_type;
 
-    std::deque<asio::const_buffer> m_messages;
+    // Pending messages are owned by the stream until they're fully written. The offset is the number
+    // of bytes of the front message which have already been written.
+    std::deque<message_type> m_messages;
     std::deque<handler_type> m_handlers;
 
-    enum class states { idle, flushing } m_state;
+    size_t m_offset;
+    size_t m_pending;
+
+    // Gather list for the next write, rebuilt on every write attempt.
+    std::vector<asio::const_buffer> m_gather;
+
+    // Coalescing limits: the maximum number of buffers and bytes per single gather write. When the
+    // coalescing is enabled, writes are not attempted immediately, but deferred until the end of the
+    // current reactor turn, so that all the messages written during this turn are flushed at once.
+    size_t m_max_buffers;
+    size_t m_max_bytes;
+
+    bool m_coalesce;
+
+    std::atomic<uint64_t> m_messages_written;
+    std::atomic<uint64_t> m_syscalls;
+
+    enum class states { idle, scheduled, flushing } m_state;
 
 public:
+    static const size_t kDefaultMaxBuffers = 64;
+
     explicit
     writable_stream(const std::shared_ptr<channel_type>& channel):
         m_channel(channel),
+        m_offset(0),
+        m_pending(0),
+        m_max_buffers(kDefaultMaxBuffers),
+        m_max_bytes(std::numeric_limits<size_t>::max()),
+        m_coalesce(false),
+        m_messages_written(0),
+        m_syscalls(0),
         m_state(states::idle)
     { }
 
+    // Enables write coalescing with the specified limits. Zero buffers disables it.
     void
-    write(const message_type& message, handler_type handle) {
-        size_t bytes_written = 0;
-
-        if(m_state == states::idle) {
-            std::error_code ec;
-
-            // Try to write some data right away, as we don't have anything pending.
-            bytes_written = m_channel->write_some(asio::buffer(message.data(), message.size()), ec);
+    coalesce(size_t max_buffers, size_t max_bytes) {
+        m_coalesce = max_buffers != 0;
 
-            if(!ec && bytes_written == message.size()) {
-                return m_channel->get_io_service().post(std::bind(handle, ec));
-            }
+        if(m_coalesce) {
+            m_max_buffers = max_buffers;
+            m_max_bytes   = max_bytes ? max_bytes : std::numeric_limits<size_t>::max();
+        } else {
+            m_max_buffers = kDefaultMaxBuffers;
+            m_max_bytes   = std::numeric_limits<size_t>::max();
         }
+    }
 
-        m_messages.emplace_back(
-            message.data() + bytes_written,
-            message.size() - bytes_written
-        );
+    // NOTE: The handle might be empty, in which case it's silently skipped. It's useful to attach
+    // a single handler to the last message of a batch, as errors are reported to every pending one.
+    void
+    write(message_type&& message, handler_type handle) {
+        m_pending += message.size();
 
-        m_handlers.emplace_back(handle);
+        m_messages.emplace_back(std::move(message));
+        m_handlers.emplace_back(std::move(handle));
 
-        if(m_state == states::flushing) {
+        if(m_state != states::idle) {
             return;
+        }
+
+        m_state = states::scheduled;
+
+        if(m_coalesce) {
+            m_channel->get_io_service().post(
+                std::bind(&writable_stream::flush_now, this->shared_from_this())
+            );
         } else {
-            m_state = states::flushing;
+            // Try to write some data right away, as we don't have anything pending.
+            flush_now();
         }
+    }
 
-        m_channel->async_write_some(
-            m_messages,
-            std::bind(&writable_stream::flush, this->shared_from_this(), ph::_1, ph::_2)
-        );
+    auto
+    coalescing() const -> bool {
+        return m_coalesce;
     }
 
     auto
     pressure() const -> size_t {
-        return asio::buffer_size(m_messages);
+        return m_pending;
+    }
+
+    auto
+    stats() const -> write_stats_t {
+        return write_stats_t{m_messages_written.load(), m_syscalls.load()};
     }
 
 private:
-    void
-    flush(const std::error_code& ec, size_t bytes_written) {
-        if(ec) {
-            if(ec == asio::error::operation_aborted) {
-                return;
-            }
+    auto
+    gather() -> const std::vector<asio::const_buffer>& {
+        m_gather.clear();
 
-            while(!m_handlers.empty()) {
-                m_channel->get_io_service().post(std::bind(m_handlers.front(), ec));
+        size_t bytes = 0;
+        size_t skip  = m_offset;
 
-                m_messages.pop_front();
-                m_handlers.pop_front();
-            }
+        for(auto it = m_messages.begin(); it != m_messages.end(); ++it) {
+            for(size_t n = 0; n < it->chunks(); ++n) {
+                const char* data;
+                size_t size;
 
-            return;
+                std::tie(data, size) = it->chunk(n);
+
+                if(skip >= size) {
+                    // Either an empty chunk or the one which has been already written.
+                    skip -= size;
+                    continue;
+                }
+
+                data += skip;
+                size -= skip;
+                skip  = 0;
+
+                if(!m_gather.empty() && (m_gather.size() == m_max_buffers || bytes + size > m_max_bytes)) {
+                    return m_gather;
+                }
+
+                m_gather.emplace_back(data, size);
+
+                bytes += size;
+            }
         }
 
+        return m_gather;
+    }
+
+    void
+    consume(size_t bytes_written) {
+        m_pending -= bytes_written;
+
         while(bytes_written) {
             BOOST_ASSERT(!m_messages.empty() && !m_handlers.empty());
 
-            const size_t message_size = asio::buffer_size(m_messages.front());
+            const size_t message_size = m_messages.front().size() - m_offset;
 
             if(message_size > bytes_written) {
-                m_messages.front() = m_messages.front() + bytes_written;
+                m_offset += bytes_written;
                 break;
             }
 
             bytes_written -= message_size;
 
+            m_messages_written++;
+
             // Queue this block's handler for invocation.
-            m_channel->get_io_service().post(std::bind(m_handlers.front(), ec));
+            if(m_handlers.front()) {
+                m_channel->get_io_service().post(std::bind(m_handlers.front(), std::error_code()));
+            }
 
             m_messages.pop_front();
             m_handlers.pop_front();
+
+            m_offset = 0;
+        }
+    }
+
+    void
+    fail(const std::error_code& ec) {
+        while(!m_handlers.empty()) {
+            if(m_handlers.front()) {
+                m_channel->get_io_service().post(std::bind(m_handlers.front(), ec));
+            }
+
+            m_messages.pop_front();
+            m_handlers.pop_front();
+        }
+
+        m_offset  = 0;
+        m_pending = 0;
+        m_state   = states::idle;
+    }
+
+    void
+    flush_now() {
+        BOOST_ASSERT(m_state == states::scheduled);
+
+        std::error_code ec;
+
+        // With coalescing enabled, everything written during the previous reactor turn goes out in
+        // a single gather write.
+        const size_t bytes_written = m_channel->write_some(gather(), ec);
+
+        m_syscalls++;
+
+        if(ec && ec != asio::error::would_block && ec != asio::error::try_again) {
+            return fail(ec);
+        }
+
+        consume(bytes_written);
+
+        if(m_messages.empty()) {
+            m_state = states::idle;
+            return;
         }
 
+        m_state = states::flushing;
+
+        m_channel->async_write_some(
+            gather(),
+            std::bind(&writable_stream::flush, this->shared_from_this(), ph::_1, ph::_2)
+        );
+    }
+
+    void
+    flush(const std::error_code& ec, size_t bytes_written) {
+        if(ec) {
+            if(ec == asio::error::operation_aborted) {
+                return;
+            }
+
+            return fail(ec);
+        }
+
+        m_syscalls++;
+
+        consume(bytes_written);
+
         if(m_messages.empty() && m_state == states::flushing) {
             m_state = states::idle;
             return;
         }
 
         m_channel->async_write_some(
-            m_messages,
+            gather(),
             std::bind(&writable_stream::flush, this->shared_from_this(), ph::_1, ph::_2)
         );
     }
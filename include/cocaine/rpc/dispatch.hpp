@@ -25,6 +25,7 @@
 #include "cocaine/locked_ptr.hpp"
 
 #include "cocaine/rpc/graph.hpp"
+#include "cocaine/rpc/metrics.hpp"
 
 #include "cocaine/rpc/slot/blocking.hpp"
 #include "cocaine/rpc/slot/deferred.hpp"
@@ -34,8 +35,12 @@
 
 #include "cocaine/traits/tuple.hpp"
 
-#include <boost/mpl/transform.hpp>
+#include <array>
+#include <atomic>
+
 #include <boost/mpl/lambda.hpp>
+#include <boost/mpl/size.hpp>
+#include <boost/mpl/transform.hpp>
 
 #include <boost/variant/apply_visitor.hpp>
 #include <boost/variant/static_visitor.hpp>
@@ -89,6 +94,26 @@ public:
     virtual
     int
     version() const = 0;
+
+    // Enables the invocation metrics, if the instrumentation is on. Only service prototypes are
+    // instrumented, so that short-lived per-channel dispatches don't allocate histograms nobody ever
+    // reads. Must be called before the dispatch is published to any session.
+
+    virtual
+    void
+    instrument() const;
+
+    // Invocation metrics for every slot which has been called at least once, keyed by the message
+    // name. Empty, unless this dispatch has been instrumented. Services might extend them with their
+    // own runtime metrics.
+    virtual
+    auto
+    metrics() const -> dynamic_t;
+
+protected:
+    virtual
+    auto
+    slot_metrics(int id) const -> const slot_metrics_t*;
 };
 
 } // namespace io
@@ -113,12 +138,28 @@ class dispatch:
         typename mpl::lambda<make_slot_over<mpl::_1>>::type
     >::type slot_types;
 
-    typedef std::map<
-        int,
-        typename boost::make_variant_over<slot_types>::type
-    > slot_map_t;
+    typedef typename boost::make_variant_over<slot_types>::type slot_variant_t;
+
+    // Slot table
+
+    enum constants { kSlotCount = mpl::size<typename io::messages<Tag>::type>::value };
+
+    // Message IDs are consecutive positions in the protocol hierarchy, so the table is indexed by the
+    // message ID directly. Lookups are lock-free and don't do any reference counting.
+    std::array<std::atomic<const slot_variant_t*>, kSlotCount> m_slots;
 
-    synchronized<slot_map_t> m_slots;
+    // Owns the slots published in the table, one per message ID. Slots can only be (re)bound before
+    // the dispatch starts processing messages, so a slot which is replaced or forgotten can be freed
+    // right away: no reader can possibly see it yet. After that the table is immutable.
+    std::array<std::unique_ptr<const slot_variant_t>, kSlotCount> m_storage;
+
+    // Set by the first process() call. Slot (de)registration past this point is rejected, because
+    // some other thread might be using the slot that would be destroyed.
+    mutable std::atomic<bool> m_sealed;
+
+    // Per-slot invocation metrics, indexed by the message ID just like the slot table. Allocated only
+    // for instrumented dispatches, see instrument(), which is the only place where it's modified.
+    mutable std::unique_ptr<std::array<io::slot_metrics_t, kSlotCount>> m_metrics;
 
     // Slot traits
 
@@ -135,8 +176,13 @@ class dispatch:
 public:
     explicit
     dispatch(const std::string& name):
-        basic_dispatch_t(name)
-    { }
+        basic_dispatch_t(name),
+        m_sealed(false)
+    {
+        for(auto it = m_slots.begin(); it != m_slots.end(); ++it) {
+            it->store(nullptr, std::memory_order_relaxed);
+        }
+    }
 
     template<class Event, class F>
     dispatch&
@@ -167,10 +213,22 @@ public:
         return io::protocol<Tag>::version::value;
     }
 
+    virtual
+    void
+    instrument() const {
+        if(io::metrics_enabled() && !m_metrics) {
+            m_metrics = std::make_unique<std::array<io::slot_metrics_t, kSlotCount>>();
+        }
+    }
+
+protected:
+    virtual
+    auto
+    slot_metrics(int id) const -> const io::slot_metrics_t*;
+
 private:
-    template<class Visitor>
-    typename Visitor::result_type
-    visit(int id, const Visitor& visitor) const;
+    auto
+    resolve(int id) const -> const slot_variant_t&;
 };
 
 template<class Tag>
@@ -195,14 +253,54 @@ struct select<streamed<R>, Event> {
     typedef io::deferred_slot<streamed, Event> type;
 };
 
+// Pinning of the receive buffer segments for the arguments unpacked as slices
+
+template<size_t N>
+struct pin_impl {
+    template<class Tuple>
+    static inline
+    void
+    apply(Tuple& args, const io::decoder_t::message_type& message) {
+        pin_impl<N - 1>::apply(args, message);
+        pin_element(std::get<N - 1>(args), message);
+    }
+
+private:
+    template<class T>
+    static inline
+    void
+    pin_element(T& COCAINE_UNUSED_(element), const io::decoder_t::message_type& COCAINE_UNUSED_(message)) {
+        // Empty.
+    }
+
+    static inline
+    void
+    pin_element(io::slice_t& element, const io::decoder_t::message_type& message) {
+        message.pin(element);
+    }
+};
+
+template<>
+struct pin_impl<0> {
+    template<class Tuple>
+    static inline
+    void
+    apply(Tuple& COCAINE_UNUSED_(args), const io::decoder_t::message_type& COCAINE_UNUSED_(message)) {
+        // Empty.
+    }
+};
+
 // Slot invocation with arguments provided as a MessagePack object
 
 struct calling_visitor_t:
     public boost::static_visitor<io::transition_t>
 {
-    calling_visitor_t(const msgpack::object& unpacked_, const io::upstream_ptr_t& upstream_):
-        unpacked(unpacked_),
-        upstream(upstream_)
+    calling_visitor_t(const io::decoder_t::message_type& message_, const io::upstream_ptr_t& upstream_,
+                      io::slot_metrics_t* metrics_ = nullptr)
+    :
+        message(message_),
+        upstream(upstream_),
+        metrics(metrics_)
     { }
 
     template<class Event>
@@ -213,22 +311,46 @@ struct calling_visitor_t:
         // Unpacked arguments storage.
         typename slot_type::tuple_type args;
 
+        if(metrics == nullptr) {
+            unpack<Event>(args);
+
+            // Call the slot with the upstream constrained with the event's upstream protocol type tag.
+            return result_type((*slot)(std::move(args), typename slot_type::upstream_type(upstream)));
+        }
+
+        io::slot_metrics_t::timer_t timer(*metrics);
+
+        unpack<Event>(args);
+        timer.unpacked();
+
+        result_type result((*slot)(std::move(args), typename slot_type::upstream_type(upstream)));
+        timer.complete();
+
+        return result;
+    }
+
+private:
+    template<class Event, class Tuple>
+    void
+    unpack(Tuple& args) const {
         try {
             // NOTE: Unpacks the object into a tuple using the argument typelist unlike using plain
             // tuple type traits, in order to support parameter tags, like optional<T>.
-            io::type_traits<typename io::event_traits<Event>::argument_type>::unpack(unpacked, args);
+            io::type_traits<typename io::event_traits<Event>::argument_type>::unpack(message.args(), args);
         } catch(const msgpack::type_error& e) {
             // TODO: Throw a system_error with some meaningful error code.
             throw cocaine::error_t("unable to unpack message arguments");
         }
 
-        // Call the slot with the upstream constrained with the event's upstream protocol type tag.
-        return result_type((*slot)(std::move(args), typename slot_type::upstream_type(upstream)));
+        // Slices reference the receive buffer, so it must be kept alive as long as they are.
+        pin_impl<std::tuple_size<Tuple>::value>::apply(args, message);
     }
 
 private:
-    const msgpack::object&    unpacked;
+    const io::decoder_t::message_type& message;
     const io::upstream_ptr_t& upstream;
+
+    io::slot_metrics_t *const metrics;
 };
 
 } // namespace aux
@@ -251,10 +373,17 @@ dispatch<Tag>&
 dispatch<Tag>::on(const std::shared_ptr<io::basic_slot<Event>>& ptr) {
     typedef io::event_traits<Event> traits;
 
-    if(!m_slots->insert(std::make_pair(traits::id, ptr)).second) {
+    if(m_sealed.load(std::memory_order_relaxed)) {
+        throw cocaine::error_t("type %d slot can't be bound to a dispatch in use", traits::id);
+    }
+
+    if(m_storage[traits::id]) {
         throw cocaine::error_t("duplicate type %d slot: %s", traits::id, Event::alias());
     }
 
+    m_storage[traits::id] = std::make_unique<const slot_variant_t>(ptr);
+    m_slots[traits::id].store(m_storage[traits::id].get(), std::memory_order_release);
+
     return *this;
 }
 
@@ -262,41 +391,68 @@ template<class Tag>
 template<class Event>
 void
 dispatch<Tag>::forget() {
-    if(!m_slots->erase(io::event_traits<Event>::id)) {
-        throw cocaine::error_t("type %d slot does not exist", io::event_traits<Event>::id);
+    typedef io::event_traits<Event> traits;
+
+    if(m_sealed.load(std::memory_order_relaxed)) {
+        throw cocaine::error_t("type %d slot can't be forgotten by a dispatch in use", traits::id);
     }
+
+    if(!m_storage[traits::id]) {
+        throw cocaine::error_t("type %d slot does not exist", traits::id);
+    }
+
+    // Nobody could have seen the slot yet, so it's safe to destroy it right away.
+    m_slots[traits::id].store(nullptr, std::memory_order_release);
+    m_storage[traits::id].reset();
 }
 
 template<class Tag>
 io::transition_t
 dispatch<Tag>::process(const io::decoder_t::message_type& message, const io::upstream_ptr_t& upstream) const {
-    return visit(message.type(), aux::calling_visitor_t(message.args(), upstream));
+    if(!m_sealed.load(std::memory_order_relaxed)) {
+        m_sealed.store(true, std::memory_order_relaxed);
+    }
+
+    // Resolve the slot first, so that messages for unknown or unbound slots are rejected before they
+    // are accounted anywhere.
+    const slot_variant_t& slot = resolve(message.type());
+
+    io::slot_metrics_t* metrics = nullptr;
+
+    if(m_metrics) {
+        metrics = &(*m_metrics)[message.type()];
+        metrics->bytes.fetch_add(message.size(), std::memory_order_relaxed);
+    }
+
+    // NOTE: No need to copy the slot pointer here, because the slot table is immutable once the
+    // dispatch has started processing messages, so the slot lives as long as the dispatch does.
+    return boost::apply_visitor(aux::calling_visitor_t(message, upstream, metrics), slot);
 }
 
 template<class Tag>
-template<class Visitor>
-typename Visitor::result_type
-dispatch<Tag>::visit(int id, const Visitor& visitor) const {
-    typename slot_map_t::const_iterator lb, ub;
-    typename slot_map_t::mapped_type slot;
+const io::slot_metrics_t*
+dispatch<Tag>::slot_metrics(int id) const {
+    if(!m_metrics || id < 0 || id >= kSlotCount) {
+        return nullptr;
+    }
 
-    {
-        auto ptr = m_slots.synchronize();
-
-        // NOTE: Using equal_range() here, instead of find() to check for slot existence and get the
-        // slot pointer in one call instead of two.
-        std::tie(lb, ub) = ptr->equal_range(id);
-
-        if(lb != ub) {
-            // NOTE: The slot pointer is copied here, allowing the handling code to unregister slots
-            // via dispatch<T>::forget() without pulling the object from underneath itself.
-            slot = lb->second;
-        } else {
-            throw cocaine::error_t("unbound type %d slot", id);
-        }
+    return &(*m_metrics)[id];
+}
+
+template<class Tag>
+auto
+dispatch<Tag>::resolve(int id) const -> const slot_variant_t& {
+    const slot_variant_t* slot = nullptr;
+
+    if(id >= 0 && id < kSlotCount) {
+        slot = m_slots[id].load(std::memory_order_acquire);
+    }
+
+    if(slot == nullptr) {
+        throw cocaine::error_t("unbound type %d slot", id);
     }
 
-    return boost::apply_visitor(visitor, slot);
+    return *slot;
 }
 
 } // namespace cocaine
@@ -0,0 +1,122 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_IO_METRICS_HPP
+#define COCAINE_IO_METRICS_HPP
+
+#include "cocaine/common.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace cocaine { namespace io {
+
+// Process-wide instrumentation switch. Only service prototypes which have been instrumented while
+// it's on collect metrics, the others don't even allocate them, so there's virtually no overhead
+// when it's off, nor for the per-channel dispatches when it's on.
+
+bool
+metrics_enabled();
+
+void
+enable_metrics(bool enabled);
+
+// Lock-free latency histogram with logarithmic buckets: the first bucket counts sub-microsecond
+// samples, and every next one counts samples in [2^(N-1), 2^N) microseconds. Percentiles are only
+// accurate within a factor of two, which is enough to tell slow methods from fast ones.
+
+class histogram_t {
+    COCAINE_DECLARE_NONCOPYABLE(histogram_t)
+
+    enum constants { kBucketCount = 40 };
+
+    std::array<std::atomic<uint64_t>, kBucketCount> m_buckets;
+
+    // Total sum and the maximum of all the recorded samples in microseconds.
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+
+public:
+    histogram_t();
+
+    void
+    record(uint64_t value);
+
+    auto
+    count() const -> uint64_t;
+
+    // Upper bound of the bucket containing the given quantile, in microseconds.
+    auto
+    percentile(double quantile) const -> uint64_t;
+
+    auto
+    info() const -> dynamic_t;
+};
+
+// Per-slot invocation metrics.
+
+struct slot_metrics_t {
+    COCAINE_DECLARE_NONCOPYABLE(slot_metrics_t)
+
+#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
+    typedef std::chrono::steady_clock clock_type;
+#else
+    typedef std::chrono::monotonic_clock clock_type;
+#endif
+
+    // Measures a single invocation. Unless completed, the invocation is accounted as failed.
+    class timer_t {
+        slot_metrics_t& metrics;
+        clock_type::time_point stamp;
+
+        bool completed;
+
+    public:
+        explicit
+        timer_t(slot_metrics_t& metrics);
+
+       ~timer_t();
+
+        void
+        unpacked();
+
+        void
+        complete();
+    };
+
+    slot_metrics_t();
+
+    std::atomic<uint64_t> calls;
+    std::atomic<uint64_t> errors;
+
+    // Total size of the incoming messages.
+    std::atomic<uint64_t> bytes;
+
+    histogram_t unpacking;
+    histogram_t execution;
+
+    auto
+    info() const -> dynamic_t;
+};
+
+}} // namespace cocaine::io
+
+#endif
@@ -0,0 +1,100 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_IO_OFFLOAD_HPP
+#define COCAINE_IO_OFFLOAD_HPP
+
+#include "cocaine/common.hpp"
+#include "cocaine/locked_ptr.hpp"
+
+#include <atomic>
+#include <functional>
+
+#include <asio/io_service.hpp>
+
+#define BOOST_BIND_NO_PLACEHOLDERS
+#include <boost/thread/thread.hpp>
+
+namespace cocaine { namespace io {
+
+// Per-slot offloading counters. Times are accumulated in microseconds, so average latencies can be
+// calculated by dividing them by the number of processed invocations.
+struct offload_stats_t {
+    offload_stats_t();
+
+    // Invocations which are either waiting for a worker thread or being executed right now.
+    std::atomic<size_t> queued;
+
+    // Completed and rejected due to the queue limit invocations.
+    std::atomic<uint64_t> processed;
+    std::atomic<uint64_t> rejected;
+
+    // Total time spent in the queue and executing.
+    std::atomic<uint64_t> waiting;
+    std::atomic<uint64_t> running;
+};
+
+// Bounded worker pool for slots which can't be executed on the reactor thread without stalling all
+// the other sessions multiplexed on it, e.g. slots doing synchronous disk I/O. The pool is usually
+// owned by the service and shared between all its offloaded slots.
+class offload_pool_t {
+    COCAINE_DECLARE_NONCOPYABLE(offload_pool_t)
+
+    // Maximum number of pending invocations, including the ones being executed.
+    const size_t m_limit;
+
+    std::atomic<size_t> m_depth;
+
+    asio::io_service m_asio;
+    std::unique_ptr<asio::io_service::work> m_work;
+
+    boost::thread_group m_threads;
+
+    // Counters for every slot attached to this pool, keyed by the slot name.
+    synchronized<std::map<std::string, std::shared_ptr<offload_stats_t>>> m_stats;
+
+public:
+    offload_pool_t(size_t threads, size_t limit);
+
+    // Waits for all the already queued invocations to complete.
+   ~offload_pool_t();
+
+    // Observers
+
+    auto
+    depth() const -> size_t;
+
+    auto
+    stats() const -> dynamic_t;
+
+    // Modifiers
+
+    auto
+    attach(const std::string& slot) -> std::shared_ptr<offload_stats_t>;
+
+    // Schedules the task for execution on some worker thread. Returns false if the queue is full,
+    // in which case the task is dropped and the caller is responsible to report the failure.
+    bool
+    post(const std::shared_ptr<offload_stats_t>& stats, std::function<void()> task);
+};
+
+}} // namespace cocaine::io
+
+#endif
@@ -54,9 +54,16 @@ struct frozen {
         tuple(std::forward<Args>(args)...)
     { }
 
+    frozen(event_type, const preencoded<event_type>& payload_):
+        payload(payload_)
+    { }
+
     // NOTE: If the message cannot be sent right away, then the message arguments are placed into a
     // temporary storage until the upstream is attached.
     tuple_type tuple;
+
+    // Or, if the arguments have been already encoded, the encoded payload is stored instead.
+    preencoded<event_type> payload;
 };
 
 template<class Event, typename... Args>
@@ -71,19 +78,49 @@ struct frozen_visitor:
 {
     typedef Upstream upstream_type;
 
-    explicit
-    frozen_visitor(const std::shared_ptr<upstream_type>& upstream_):
-        upstream(upstream_)
+    frozen_visitor(const std::shared_ptr<upstream_type>& upstream_, encoder_t::message_type& batch_):
+        upstream(upstream_),
+        batch(batch_)
     { }
 
     template<class Event>
     void
     operator()(const frozen<Event>& frozen) const {
-        upstream->template send<Event>(frozen.tuple);
+        if(!frozen.payload.empty()) {
+            upstream->template append<Event>(batch, frozen.payload);
+        } else {
+            upstream->template append<Event>(batch, frozen.tuple);
+        }
     }
 
 private:
     const std::shared_ptr<upstream_type>& upstream;
+    encoder_t::message_type& batch;
+};
+
+// Flushes the pending batch of the queue. Scheduled by the owner of the queue on the upstream's
+// reactor thread, when the first message is deferred into an empty batch. The session might have
+// been detached by the time the flush runs, in which case the batch is dropped, as there's no one
+// to deliver it to anymore and nobody to report the error to on the reactor thread.
+
+template<class Queue>
+class flush_action_t {
+    const std::shared_ptr<synchronized<Queue>> queue;
+
+public:
+    explicit
+    flush_action_t(const std::shared_ptr<synchronized<Queue>>& queue_):
+        queue(queue_)
+    { }
+
+    void
+    operator()() const {
+        try {
+            queue->synchronize()->flush();
+        } catch(const cocaine::error_t&) {
+            // Empty.
+        }
+    }
 };
 
 } // namespace aux
@@ -106,7 +143,17 @@ class message_queue {
     // thread safety - the atomicity guarantee of the shared_ptr<T> is not enough.
     std::shared_ptr<upstream_type> m_upstream;
 
+    // Messages encoded since the last flush. They are pushed into the upstream as a single buffer.
+    encoder_t::message_type m_batch;
+
+    // Producers waiting for the upstream to be attached, see await().
+    std::vector<std::function<void()>> m_waiters;
+
 public:
+    // Deferred messages are flushed right away once the batch grows over this size.
+    static const size_t kMaxBatchSize = 65536;
+
+    // Sends the message right away, along with any deferred messages preceding it.
     template<class Event, typename... Args>
     void
     append(Args&&... args) {
@@ -119,7 +166,70 @@ public:
             return m_operations.emplace_back(aux::make_frozen<Event>(std::forward<Args>(args)...));
         }
 
-        m_upstream->template send<Event>(std::forward<Args>(args)...);
+        m_upstream->template append<Event>(m_batch, std::forward<Args>(args)...);
+
+        flush();
+    }
+
+    // Encodes the message into the pending batch without sending it. Returns true if the batch was
+    // empty, in which case the caller is responsible for scheduling the flush via schedule(). This
+    // way, all the messages deferred within a single handler invocation are sent at once.
+    template<class Event, typename... Args>
+    bool
+    defer(Args&&... args) {
+        static_assert(
+            std::is_same<typename Event::tag, Tag>::value,
+            "message protocol is not compatible with this message queue"
+        );
+
+        if(!m_upstream) {
+            m_operations.emplace_back(aux::make_frozen<Event>(std::forward<Args>(args)...));
+            return false;
+        }
+
+        const bool pristine = m_batch.empty();
+
+        m_upstream->template append<Event>(m_batch, std::forward<Args>(args)...);
+
+        if(std::is_same<typename event_traits<Event>::dispatch_type, void>::value
+            || m_batch.size() >= kMaxBatchSize)
+        {
+            flush();
+            return false;
+        }
+
+        return pristine && !m_batch.empty();
+    }
+
+    // Throws if the upstream's session has been detached, so that the writer finds out about it
+    // right away, the same way as if the message has been pushed directly. The pending batch is then
+    // dropped, so that every subsequent deferred message reports the error as well.
+    template<class Handler>
+    void
+    schedule(const Handler& handler) {
+        if(!m_upstream) {
+            return;
+        }
+
+        try {
+            m_upstream->post(handler);
+        } catch(...) {
+            m_batch = encoder_t::message_type();
+            throw;
+        }
+    }
+
+    void
+    flush() {
+        if(m_batch.empty()) {
+            return;
+        }
+
+        // Move the batch out first, so that the queue starts with an empty batch even if the push
+        // fails.
+        encoder_t::message_type batch(std::move(m_batch));
+
+        m_upstream->push(std::move(batch));
     }
 
     template<class OtherTag>
@@ -133,19 +243,43 @@ public:
         attach(std::move(upstream.ptr));
     }
 
+    auto
+    would_block() const -> bool {
+        return m_upstream && m_upstream->would_block();
+    }
+
+    // Schedules the handler once the upstream is attached and can take more messages without the
+    // session's backlog growing any further. Never calls the handler synchronously, so it's safe to
+    // call it with the queue locked.
+    void
+    await(const std::function<void()>& handler) {
+        if(!m_upstream) {
+            return m_waiters.push_back(handler);
+        }
+
+        m_upstream->await(handler);
+    }
+
     void
     attach(std::shared_ptr<upstream_type> upstream) {
         m_upstream = std::move(upstream);
 
-        if(m_operations.empty()) {
-            return;
-        }
+        if(!m_operations.empty()) {
+            aux::frozen_visitor<upstream_type> visitor(m_upstream, m_batch);
 
-        aux::frozen_visitor<upstream_type> visitor(m_upstream);
+            std::for_each(m_operations.begin(), m_operations.end(), boost::apply_visitor(visitor));
 
-        std::for_each(m_operations.begin(), m_operations.end(), boost::apply_visitor(visitor));
+            m_operations.clear();
+
+            // All the operations accumulated before the upstream was attached are sent at once.
+            flush();
+        }
+
+        for(auto it = m_waiters.begin(); it != m_waiters.end(); ++it) {
+            m_upstream->await(*it);
+        }
 
-        m_operations.clear();
+        m_waiters.clear();
     }
 };
 
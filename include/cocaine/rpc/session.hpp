@@ -27,7 +27,12 @@
 #include "cocaine/rpc/asio/encoder.hpp"
 #include "cocaine/rpc/asio/decoder.hpp"
 
+#include "cocaine/rpc/slab.hpp"
+
+#include <atomic>
+#include <functional>
 #include <mutex>
+#include <vector>
 
 #include <asio/ip/tcp.hpp>
 
@@ -49,7 +54,15 @@ class session_t:
     class pull_action_t;
     class push_action_t;
 
-    typedef std::map<uint64_t, std::shared_ptr<channel_t>> channel_map_t;
+    // Inspects the channel map on the reactor thread.
+    class snapshot_action_t;
+
+    typedef std::map<
+        uint64_t,
+        std::shared_ptr<channel_t>,
+        std::less<uint64_t>,
+        io::slab_allocator<std::pair<const uint64_t, std::shared_ptr<channel_t>>>
+    > channel_map_t;
 
     // The underlying connection.
     synchronized<std::shared_ptr<io::channel<asio::ip::tcp>>> transport;
@@ -62,16 +75,60 @@ class session_t:
 
     // The maximum channel id processed by the session. The session assumes that ids of incoming
     // channels are strongly increasing and discards messages with old channel ids.
-    uint64_t max_channel_id;
+    std::atomic<uint64_t> max_channel_id;
+
+    // Virtual channels. The channel map is owned by the session's reactor thread, so the per-message
+    // lookup doesn't need any locking. Channels injected or revoked from other threads are inserted
+    // or erased by the reactor thread itself, in the order of operations on the session. Channels
+    // and their map nodes are allocated from the thread-local slabs, so that opening and closing
+    // channels doesn't hit the general-purpose allocator.
+    channel_map_t channels;
+
+    // Messages pushed since the last flush. Only the push which finds the outbox empty schedules a
+    // flush, so messages pushed in a burst are handed over to the writer as a single batch.
+    synchronized<std::vector<io::encoder_t::message_type>> outbox;
+
+    // Flushed outbox storage, swapped back into the outbox on the next flush to reuse its capacity.
+    // Only accessed on the reactor thread.
+    std::vector<io::encoder_t::message_type> spare;
+
+    // Flow control. The backlog is the number of bytes pushed into the session, but not yet written
+    // to the socket. Crossing the high watermark blocks the session: reading from it is paused and
+    // upstreams report that they would block, until the backlog drops below the low watermark. Zero
+    // high watermark disables the flow control.
+    std::atomic<size_t> backlog;
+    std::atomic<bool> blocked;
+
+    size_t high_watermark;
+    size_t low_watermark;
+
+    // The read operation paused by the flow control. Only accessed on the reactor thread.
+    std::shared_ptr<pull_action_t> paused;
+
+    // Producers waiting for the session to unblock, see await().
+    synchronized<std::vector<std::function<void()>>> waiters;
 
-    // Virtual channels.
-    synchronized<channel_map_t> channels;
+    // Message counters. Incoming messages are only counted on the reactor thread.
+    uint64_t received;
+    std::atomic<uint64_t> sent;
 
 public:
     struct {
         signals::signal<void(const std::error_code&)> shutdown;
     } signals;
 
+    struct stats_t {
+        size_t channels;
+
+        // Total number of messages received and sent.
+        uint64_t received;
+        uint64_t sent;
+
+        // Bytes buffered in the read and write rings.
+        size_t pending_read;
+        size_t pending_write;
+    };
+
 public:
     session_t(std::unique_ptr<io::channel<asio::ip::tcp>> transport, const io::dispatch_ptr_t& prototype);
 
@@ -91,6 +148,26 @@ public:
     void
     push(io::encoder_t::message_type&& message);
 
+    // Schedules the handler on the session's reactor thread. Throws if the session has been already
+    // detached, like push() does.
+    void
+    post(const std::function<void()>& handler);
+
+    // Flow control
+
+    void
+    watermarks(size_t high, size_t low);
+
+    auto
+    would_block() const -> bool;
+
+    // Schedules the handler on the session's reactor thread once the backlog drains below the low
+    // watermark, or right away if the session isn't blocked, so that producers could hold off until
+    // the client catches up. Waiting handlers are called when the session is detached as well, then
+    // they find out that the session is gone on the next push. Throws if it's already detached.
+    void
+    await(const std::function<void()>& handler);
+
     // NOTE: Detaching a session destroys the connection but not necessarily the session itself, as
     // it might be still in use by shared upstreams even in other threads. In other words, this does
     // not guarantee that the session will be actually deleted, but it's fine, since the connection
@@ -101,12 +178,25 @@ public:
 
     // Information
 
-    auto
-    active_channels() const -> std::map<uint64_t, std::string>;
+    typedef std::map<uint64_t, std::string> channel_names_t;
+
+    // The channel map can only be inspected on the session's reactor thread, so the handler is
+    // invoked asynchronously on that thread. If the session is detached, the handler is invoked
+    // right away with an empty map.
+    void
+    active_channels(const std::function<void(const channel_names_t&)>& handler);
 
     size_t
     memory_pressure() const;
 
+    auto
+    write_stats() const -> io::write_stats_t;
+
+    // NOTE: Unlike the other observers, it inspects the channel map directly, so it must be called
+    // on the session's reactor thread.
+    auto
+    stats() const -> stats_t;
+
     auto
     name() const -> std::string;
 
@@ -116,6 +206,18 @@ public:
 private:
     void
     invoke(const io::decoder_t::message_type& message);
+
+    void
+    insert(uint64_t channel_id, const std::shared_ptr<channel_t>& channel);
+
+    void
+    erase(uint64_t channel_id);
+
+    void
+    release(size_t bytes);
+
+    auto
+    snapshot() const -> std::map<uint64_t, std::string>;
 };
 
 } // namespace cocaine
@@ -0,0 +1,153 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_IO_SLAB_HPP
+#define COCAINE_IO_SLAB_HPP
+
+#include "cocaine/common.hpp"
+
+#include <array>
+#include <limits>
+
+namespace cocaine { namespace io {
+
+// Pool of small fixed-size blocks for objects which are allocated and freed at a high rate, like
+// virtual channels. Blocks are split into a few size classes, freed blocks are kept in intrusive
+// free lists, so that the steady state doesn't hit the general-purpose allocator at all. Blocks
+// larger than the largest class are allocated and freed directly. Not synchronized, every thread
+// uses its own slab, see slab_t::local().
+//
+// NOTE: All the blocks of the same class are of the same size and come from the general-purpose
+// allocator, so a block allocated from one thread's slab can be freed into another thread's slab.
+// Such blocks simply migrate between the threads, and every slab caches a bounded number of them.
+
+class slab_t {
+    COCAINE_DECLARE_NONCOPYABLE(slab_t)
+
+    enum constants { kGranularity = 64, kClassCount = 4 };
+
+    // Each size class caches at most this many free blocks, the rest are given back.
+    static const size_t kMaxCachedBlocks = 1024;
+
+    struct block_t {
+        block_t * next;
+    };
+
+    struct class_t {
+        block_t * head;
+        size_t    size;
+    };
+
+    std::array<class_t, kClassCount> m_classes;
+
+public:
+    slab_t();
+   ~slab_t();
+
+    // The calling thread's slab, created on first use and destroyed with the thread.
+    static
+    slab_t&
+    local();
+
+    auto
+    allocate(size_t size) -> void*;
+
+    void
+    deallocate(void* ptr, size_t size);
+};
+
+// Standard allocator interface for the thread-local slabs. Stateless, so that objects with shared
+// ownership could be safely freed from any thread, even after their owner is gone.
+
+template<class T>
+class slab_allocator {
+public:
+    typedef T value_type;
+
+    typedef T * pointer;
+    typedef const T * const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template<class U>
+    struct rebind {
+        typedef slab_allocator<U> other;
+    };
+
+    slab_allocator() { }
+
+    template<class U>
+    slab_allocator(const slab_allocator<U>&) { }
+
+    pointer
+    allocate(size_type count, const void* = nullptr) {
+        return static_cast<pointer>(slab_t::local().allocate(count * sizeof(T)));
+    }
+
+    void
+    deallocate(pointer ptr, size_type count) {
+        slab_t::local().deallocate(ptr, count * sizeof(T));
+    }
+
+    template<typename... Args>
+    void
+    construct(pointer ptr, Args&&... args) {
+        ::new(static_cast<void*>(ptr)) T(std::forward<Args>(args)...);
+    }
+
+    void
+    destroy(pointer ptr) {
+        ptr->~T();
+    }
+
+    pointer
+    address(reference value) const {
+        return &value;
+    }
+
+    const_pointer
+    address(const_reference value) const {
+        return &value;
+    }
+
+    size_type
+    max_size() const {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    template<class U>
+    bool
+    operator==(const slab_allocator<U>&) const {
+        return true;
+    }
+
+    template<class U>
+    bool
+    operator!=(const slab_allocator<U>&) const {
+        return false;
+    }
+};
+
+}} // namespace cocaine::io
+
+#endif
@@ -22,6 +22,7 @@
 #define COCAINE_IO_SLOT_HPP
 
 #include "cocaine/rpc/protocol.hpp"
+#include "cocaine/rpc/asio/decoder.hpp"
 
 #include "cocaine/tuple.hpp"
 
@@ -40,7 +41,7 @@ class basic_slot {
 public:
     typedef typename mpl::transform<
         typename traits_type::argument_type,
-        typename mpl::lambda<io::details::unwrap_type<mpl::_1>>
+        typename mpl::lambda<io::details::unwrap_argument<mpl::_1>>
     >::type sequence_type;
 
     // Expected dispatch, parameter and upstream types.
@@ -128,6 +128,12 @@ struct deferred {
         return *this;
     }
 
+    // Checks whether the client is too slow to consume the results.
+    bool
+    would_block() const {
+        return outbox->synchronize()->would_block();
+    }
+
 private:
     const std::shared_ptr<synchronized<queue_type>> outbox;
 };
@@ -157,6 +163,11 @@ struct deferred<void> {
         return *this;
     }
 
+    bool
+    would_block() const {
+        return outbox->synchronize()->would_block();
+    }
+
 private:
     const std::shared_ptr<synchronized<queue_type>> outbox;
 };
@@ -0,0 +1,104 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COCAINE_IO_OFFLOADED_SLOT_HPP
+#define COCAINE_IO_OFFLOADED_SLOT_HPP
+
+#include "cocaine/rpc/offload.hpp"
+#include "cocaine/rpc/slot/blocking.hpp"
+
+namespace cocaine { namespace io {
+
+// Blocking slot executed on an offload pool instead of the reactor thread. The transition is done
+// immediately, while the result is sent through the upstream later on, just like deferred slots do.
+// When the pool is saturated, invocations are rejected with a resource error.
+
+template<class Event>
+struct offloaded_slot:
+    public basic_slot<Event>
+{
+    static_assert(
+        !std::is_same<typename result_of<Event>::type, mute_slot_tag>::value,
+        "mute slots can't be offloaded"
+    );
+
+    typedef blocking_slot<Event> slot_type;
+
+    typedef typename slot_type::callable_type callable_type;
+    typedef typename slot_type::dispatch_type dispatch_type;
+    typedef typename slot_type::tuple_type tuple_type;
+    typedef typename slot_type::upstream_type upstream_type;
+    typedef typename slot_type::protocol protocol;
+
+    offloaded_slot(const std::shared_ptr<offload_pool_t>& pool_, callable_type callable):
+        pool(pool_),
+        stats(pool_->attach(Event::alias())),
+        slot(std::make_shared<slot_type>(callable))
+    { }
+
+    virtual
+    boost::optional<std::shared_ptr<const dispatch_type>>
+    operator()(tuple_type&& args, upstream_type&& upstream) {
+        auto task = std::make_shared<task_t>(slot, std::move(args), std::move(upstream));
+
+        if(!pool->post(stats, std::bind(&task_t::operator(), task))) {
+            task->upstream.template send<typename protocol::error>(
+                error::resource_error,
+                std::string("offload queue is full")
+            );
+        }
+
+        if(is_recursive<Event>::value) {
+            return boost::none;
+        } else {
+            return boost::make_optional<std::shared_ptr<const dispatch_type>>(nullptr);
+        }
+    }
+
+private:
+    struct task_t {
+        task_t(const std::shared_ptr<slot_type>& slot_, tuple_type&& args_, upstream_type&& upstream_):
+            slot(slot_),
+            args(std::move(args_)),
+            upstream(std::move(upstream_))
+        { }
+
+        void
+        operator()() {
+            // The transition has already been made on the reactor thread.
+            (*slot)(std::move(args), std::move(upstream));
+        }
+
+        const std::shared_ptr<slot_type> slot;
+
+        tuple_type    args;
+        upstream_type upstream;
+    };
+
+    const std::shared_ptr<offload_pool_t> pool;
+    const std::shared_ptr<offload_stats_t> stats;
+
+    // The wrapped slot, which does all the actual work including error reporting.
+    const std::shared_ptr<slot_type> slot;
+};
+
+}} // namespace cocaine::io
+
+#endif
@@ -44,7 +44,26 @@ struct streamed {
         streamed&
     >::type
     write(U&& value) {
-        outbox->synchronize()->template append<typename protocol::chunk>(std::forward<U>(value));
+        auto queue = outbox->synchronize();
+
+        // Chunks written in a row are encoded into a single buffer, which is flushed at the end of
+        // the current reactor turn of the upstream's session.
+        if(queue->template defer<typename protocol::chunk>(std::forward<U>(value))) {
+            queue->schedule(io::aux::flush_action_t<queue_type>(outbox));
+        }
+
+        return *this;
+    }
+
+    // Writes a chunk which has been encoded beforehand, e.g. to broadcast it to a number of streams.
+    streamed&
+    write(const io::preencoded<typename protocol::chunk>& payload) {
+        auto queue = outbox->synchronize();
+
+        if(queue->template defer<typename protocol::chunk>(payload)) {
+            queue->schedule(io::aux::flush_action_t<queue_type>(outbox));
+        }
+
         return *this;
     }
 
@@ -60,6 +79,20 @@ struct streamed {
         return *this;
     }
 
+    // Checks whether the client is too slow to consume the stream. Producers are expected to throttle
+    // themselves when it returns true, otherwise the chunks are buffered in memory.
+    bool
+    would_block() const {
+        return outbox->synchronize()->would_block();
+    }
+
+    // Schedules the handler on the session's reactor thread once the client has caught up with the
+    // stream, so that a throttled producer could carry on.
+    void
+    await(const std::function<void()>& handler) {
+        outbox->synchronize()->await(handler);
+    }
+
 private:
     const std::shared_ptr<synchronized<queue_type>> outbox;
 };
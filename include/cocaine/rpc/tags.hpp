@@ -37,6 +37,14 @@ struct optional;
 template<class T, T Default>
 struct optional_with_default;
 
+// Raw arguments (strings) tagged as views are handed over to slots as slices of the receive buffer,
+// instead of being copied out of it. For senders, they are indistinguishable from untagged ones.
+
+template<class T>
+struct view;
+
+struct slice_t;
+
 // Forward common protocol tags
 
 template<class T>
@@ -87,6 +95,23 @@ struct unwrap_type<optional_with_default<T, Default>> {
     typedef T type;
 };
 
+template<class T>
+struct unwrap_type<view<T>> {
+    typedef T type;
+};
+
+// Argument types as seen by the slots.
+
+template<class T>
+struct unwrap_argument:
+    public unwrap_type<T>
+{ };
+
+template<class T>
+struct unwrap_argument<view<T>> {
+    typedef slice_t type;
+};
+
 // Protocol compatibility
 
 template<class T, class U>
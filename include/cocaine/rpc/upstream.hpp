@@ -47,8 +47,30 @@ public:
     void
     send(Args&&... args);
 
+    // Batching: messages are encoded into the batch and then pushed into the session at once.
+
+    template<class Event, typename... Args>
+    void
+    append(encoder_t::message_type& batch, Args&&... args);
+
+    void
+    push(encoder_t::message_type&& batch);
+
+    // Schedules the handler to be called on the session's reactor thread.
+    void
+    post(const std::function<void()>& handler);
+
     void
     drop();
+
+    // Whether the remote side doesn't keep up with the messages already sent, in which case it's a
+    // good idea to hold off sending more for a while.
+    auto
+    would_block() const -> bool;
+
+    // Schedules the handler to be called once the remote side has caught up, see session_t::await().
+    void
+    await(const std::function<void()>& handler);
 };
 
 template<class Event, typename... Args>
@@ -67,12 +89,54 @@ basic_upstream_t::send(Args&&... args) {
     session->push(encoded<Event>(channel_id, std::forward<Args>(args)...));
 }
 
+template<class Event, typename... Args>
+void
+basic_upstream_t::append(encoder_t::message_type& batch, Args&&... args) {
+    if(state != states::active) {
+        return;
+    }
+
+    if(std::is_same<typename io::event_traits<Event>::dispatch_type, void>::value) {
+        state = states::sealed;
+    }
+
+    batch.append<Event>(channel_id, std::forward<Args>(args)...);
+}
+
+inline
+void
+basic_upstream_t::push(encoder_t::message_type&& batch) {
+    if(batch.empty()) {
+        return;
+    }
+
+    session->push(std::move(batch));
+}
+
+inline
+void
+basic_upstream_t::post(const std::function<void()>& handler) {
+    session->post(handler);
+}
+
 inline
 void
 basic_upstream_t::drop() {
     session->revoke(channel_id);
 }
 
+inline
+auto
+basic_upstream_t::would_block() const -> bool {
+    return session->would_block();
+}
+
+inline
+void
+basic_upstream_t::await(const std::function<void()>& handler) {
+    session->await(handler);
+}
+
 // Forwards for the upstream<T> class
 
 template<class Tag, class Upstream> class message_queue;
@@ -110,6 +174,18 @@ public:
         // Move the actual upstream pointer down the graph.
         return std::move(ptr);
     }
+
+    // Flow control, see io::basic_upstream_t.
+
+    bool
+    would_block() const {
+        return ptr->would_block();
+    }
+
+    void
+    await(const std::function<void()>& handler) {
+        ptr->await(handler);
+    }
 };
 
 template<>
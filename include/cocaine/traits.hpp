@@ -23,6 +23,8 @@
 
 #include <msgpack.hpp>
 
+#include <string>
+
 namespace cocaine { namespace io {
 
 template<class T, class = void>
@@ -41,6 +43,28 @@ struct type_traits {
     }
 };
 
+// Estimates the packed size of an object ahead of time, so that encoding buffers could be sized
+// once. Types without a cheap estimate report zero and encoding buffers grow on demand instead.
+
+template<class T, class = void>
+struct size_traits {
+    static inline
+    size_t
+    estimate(const T& /* source */) {
+        return 0;
+    }
+};
+
+template<>
+struct size_traits<std::string> {
+    static inline
+    size_t
+    estimate(const std::string& source) {
+        // Raw header is at most 5 bytes long.
+        return source.size() + 5;
+    }
+};
+
 }} // namespace cocaine::io
 
 #endif
@@ -23,6 +23,8 @@
 
 #include "cocaine/traits.hpp"
 
+#include "cocaine/rpc/asio/encoder.hpp"
+
 namespace cocaine { namespace io {
 
 // This magic specialization allows to pack string literals. It packs only the meaningful bytes,
@@ -40,15 +42,42 @@ struct type_traits<char[N]> {
     }
 };
 
-// Specialization to pack character arrays without copying to a std::string first.
+template<size_t N>
+struct size_traits<char[N]> {
+    static inline
+    size_t
+    estimate(const char* /* source */) {
+        return N + 4;
+    }
+};
+
+// Specialization to pack character arrays without copying to a std::string first. If the array has
+// an owner, large arrays are not copied at all, but attached to encoded messages by reference.
 
 struct literal_t {
+    literal_t(const char* blob_, size_t size_):
+        blob(blob_),
+        size(size_)
+    { }
+
+    literal_t(const char* blob_, size_t size_, const std::shared_ptr<const void>& owner_):
+        blob(blob_),
+        size(size_),
+        owner(owner_)
+    { }
+
     const char * blob;
     const size_t size;
 
-    // This is needed to mark this struct as implicitly convertible to std::string, although this
-    // conversion never takes place, only statically checked in the typelist traits.
-    operator std::string() const;
+    // Keeps the blob alive while it's referenced by encoded messages.
+    const std::shared_ptr<const void> owner;
+
+    // This is needed to mark this struct as implicitly convertible to std::string for the typelist
+    // traits. The only place the conversion actually takes place is a message queue which freezes its
+    // messages until an upstream is attached, as the frozen arguments must own their data.
+    operator std::string() const {
+        return std::string(blob, size);
+    }
 };
 
 template<>
@@ -60,6 +89,35 @@ struct type_traits<literal_t> {
         target.pack_raw(source.size);
         target.pack_raw_body(source.blob, source.size);
     }
+
+    // Only encoding buffers support attachments. Any other packer, including a bare packer for them,
+    // is handled by the generic overload above, which always copies.
+    static inline
+    void
+    pack(aux::encoded_packer_t& target, const literal_t& source) {
+        target.pack_raw(source.size);
+
+        if(attachable(source)) {
+            target.buffer.attach(source.blob, source.size, source.owner);
+        } else {
+            target.pack_raw_body(source.blob, source.size);
+        }
+    }
+
+    static inline
+    bool
+    attachable(const literal_t& source) {
+        return source.owner && source.size >= aux::encoded_buffers_t::kAttachThreshold;
+    }
+};
+
+template<>
+struct size_traits<literal_t> {
+    static inline
+    size_t
+    estimate(const literal_t& source) {
+        return type_traits<literal_t>::attachable(source) ? 5 : source.size + 5;
+    }
 };
 
 }} // namespace cocaine::io
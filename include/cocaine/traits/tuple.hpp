@@ -45,6 +45,9 @@ namespace cocaine { namespace io {
 //
 // type_traits<Sequence>::pack(buffer, std::tuple<Args...> tuple);
 // type_traits<Sequence>::unpack(object, std::tuple<Args...> tuple);
+//
+// Sequences are packed with the packer they were given as is, not just its msgpack::packer<Stream>
+// base, so that element traits could overload on derived packers like aux::encoded_packer_t.
 
 namespace aux {
 
@@ -53,10 +56,10 @@ struct tuple_type_traits_impl;
 
 template<size_t... Indices>
 struct tuple_type_traits_impl<index_sequence<Indices...>> {
-    template<class Sequence, class Stream, class Tuple>
+    template<class Sequence, class Packer, class Tuple>
     static inline
     void
-    pack(msgpack::packer<Stream>& target, const Tuple& source) {
+    pack(Packer& target, const Tuple& source) {
         type_traits<Sequence>::pack(target, std::get<Indices>(source)...);
     }
 
@@ -114,6 +117,17 @@ struct unpack_sequence_impl<optional_with_default<T, Default>> {
     }
 };
 
+template<class T>
+struct unpack_sequence_impl<view<T>> {
+    template<class SourceIterator, class Target>
+    static inline
+    SourceIterator
+    apply(SourceIterator it, SourceIterator end, Target& target) {
+        // Viewed elements might be unpacked either into slices or into their original types.
+        return unpack_sequence_impl<Target>::apply(it, end, target);
+    }
+};
+
 // Exception helpers
 
 struct sequence_type_error:
@@ -171,10 +185,10 @@ struct type_traits<
     };
 
 public:
-    template<class Stream, typename... Args>
+    template<class Packer, typename... Args>
     static inline
     void
-    pack(msgpack::packer<Stream>& target, const Args&... sources) {
+    pack(Packer& target, const Args&... sources) {
         static_assert(sizeof...(sources) >= minimal, "sequence length mismatch");
 
         // The sequence will be packed as an array.
@@ -184,10 +198,10 @@ public:
         pack_sequence<typename boost::mpl::begin<T>::type>(target, sources...);
     }
 
-    template<class Stream, typename... Args>
+    template<class Packer, typename... Args>
     static inline
     void
-    pack(msgpack::packer<Stream>& target, const std::tuple<Args...>& source) {
+    pack(Packer& target, const std::tuple<Args...>& source) {
         typedef aux::tuple_type_traits_impl<
             typename make_index_sequence<sizeof...(Args)>::type
         > traits_type;
@@ -240,17 +254,17 @@ public:
     }
 
 private:
-    template<class It, class Stream>
+    template<class It, class Packer>
     static inline
     void
-    pack_sequence(msgpack::packer<Stream>& COCAINE_UNUSED_(target)) {
+    pack_sequence(Packer& COCAINE_UNUSED_(target)) {
         // Empty.
     }
 
-    template<class It, class Stream, class Head, typename... Tail>
+    template<class It, class Packer, class Head, typename... Tail>
     static inline
     void
-    pack_sequence(msgpack::packer<Stream>& target, const Head& head, const Tail&... tail) {
+    pack_sequence(Packer& target, const Head& head, const Tail&... tail) {
         typedef typename pristine<Head>::type type;
         typedef typename boost::mpl::deref<It>::type element_type;
 
@@ -303,10 +317,10 @@ struct type_traits<std::tuple<Args...>> {
         typename make_index_sequence<sizeof...(Args)>::type
     > traits_type;
 
-    template<class Stream>
+    template<class Packer>
     static inline
     void
-    pack(msgpack::packer<Stream>& target, const std::tuple<Args...>& source) {
+    pack(Packer& target, const std::tuple<Args...>& source) {
         traits_type::template pack<sequence_type>(target, source);
     }
 
@@ -90,6 +90,22 @@ actor_t::accept_action_t::finalize(const std::error_code& ec) {
     operator()();
 }
 
+namespace {
+
+struct close_action_t {
+    void
+    operator()() const {
+        std::error_code ec;
+
+        // Cancels the pending accept operation, which in turn drops the last reference to the acceptor.
+        acceptor->close(ec);
+    }
+
+    const std::shared_ptr<tcp::acceptor> acceptor;
+};
+
+} // namespace
+
 // Actor
 
 actor_t::actor_t(context_t& context, const std::shared_ptr<io_service>& asio,
@@ -99,7 +115,9 @@ actor_t::actor_t(context_t& context, const std::shared_ptr<io_service>& asio,
     m_log(context.log("core:asio")),
     m_asio(asio),
     m_prototype(std::move(prototype))
-{ }
+{
+    m_prototype->instrument();
+}
 
 actor_t::actor_t(context_t& context, const std::shared_ptr<io_service>& asio,
                  std::unique_ptr<api::service_t> service)
@@ -115,6 +133,8 @@ actor_t::actor_t(context_t& context, const std::shared_ptr<io_service>& asio,
         std::shared_ptr<api::service_t>(std::move(service)),
         prototype
     );
+
+    m_prototype->instrument();
 }
 
 actor_t::~actor_t() {
@@ -127,8 +147,10 @@ actor_t::endpoints() const {
         return std::vector<tcp::endpoint>();
     }
 
-    if(!m_acceptor->local_endpoint().address().is_unspecified()) {
-        return std::vector<tcp::endpoint>({m_acceptor->local_endpoint()});
+    const auto endpoint = local_endpoint();
+
+    if(!endpoint.address().is_unspecified()) {
+        return std::vector<tcp::endpoint>({endpoint});
     }
 
     tcp::resolver::query::flags flags =
@@ -142,7 +164,7 @@ actor_t::endpoints() const {
 
     try {
         begin = tcp::resolver(*m_asio).resolve(tcp::resolver::query(
-            m_context.config.network.hostname, std::to_string(m_acceptor->local_endpoint().port()),
+            m_context.config.network.hostname, std::to_string(endpoint.port()),
             flags
         ));
     } catch(const asio::system_error& e) {
@@ -162,7 +184,7 @@ actor_t::endpoints() const {
 
 bool
 actor_t::is_active() const {
-    return m_chamber && m_acceptor;
+    return m_chamber && (m_acceptor || !m_acceptors.empty());
 }
 
 const io::basic_dispatch_t&
@@ -174,21 +196,51 @@ void
 actor_t::run() {
     BOOST_ASSERT(!m_chamber);
 
-    m_acceptor = std::make_unique<tcp::acceptor>(*m_asio, tcp::endpoint {
+    tcp::endpoint endpoint = {
         m_context.config.network.endpoint,
         m_context.mapper.assign(m_prototype->name())
-    });
+    };
 
-    COCAINE_LOG_DEBUG(m_log, "exposing service on %s", m_acceptor->local_endpoint())(
-        "service", m_prototype->name()
-    );
+    if(m_context.config.network.reuseport) {
+        const auto& pool = m_context.pool();
 
-    m_asio->post(std::bind(&accept_action_t::operator(),
-        std::make_shared<accept_action_t>(this)
-    ));
+        try {
+            for(auto it = pool.begin(); it != pool.end(); ++it) {
+                m_acceptors.push_back((*it)->listen(endpoint, m_prototype));
+
+                // In case of an ephemeral port, the other units have to join the first one's port.
+                endpoint = m_acceptors.front()->local_endpoint();
+            }
+        } catch(...) {
+            for(auto it = m_acceptors.begin(); it != m_acceptors.end(); ++it) {
+                (*it)->get_io_service().post(close_action_t{*it});
+            }
+
+            m_acceptors.clear();
+            m_context.mapper.retain(m_prototype->name());
+
+            throw;
+        }
+
+        COCAINE_LOG_DEBUG(m_log, "exposing service on %s via %d reuseport acceptor(s)", endpoint,
+            m_acceptors.size()
+        )("service", m_prototype->name());
+    } else {
+        m_acceptor = std::make_unique<tcp::acceptor>(*m_asio, endpoint);
+
+        COCAINE_LOG_DEBUG(m_log, "exposing service on %s", m_acceptor->local_endpoint())(
+            "service", m_prototype->name()
+        );
+
+        m_asio->post(std::bind(&accept_action_t::operator(),
+            std::make_shared<accept_action_t>(this)
+        ));
+    }
 
     // The post() above won't be executed until this thread is started.
-    m_chamber = std::make_unique<io::chamber_t>(m_prototype->name(), m_asio);
+    m_chamber = std::make_unique<io::chamber_t>(m_prototype->name(), m_asio,
+        m_context.config.network.affinity.services
+    );
 }
 
 void
@@ -199,17 +251,29 @@ actor_t::terminate() {
     // happens only in engine chambers, because that's where client connections are being handled.
     m_asio->stop();
 
-    COCAINE_LOG_DEBUG(m_log, "removing service from %s", m_acceptor->local_endpoint())(
+    COCAINE_LOG_DEBUG(m_log, "removing service from %s", local_endpoint())(
         "service", m_prototype->name()
     );
 
+    // Per-unit acceptors are closed asynchronously in their own reactors.
+    for(auto it = m_acceptors.begin(); it != m_acceptors.end(); ++it) {
+        (*it)->get_io_service().post(close_action_t{*it});
+    }
+
     // Does not block, unlike the one in execution_unit_t's destructors.
     m_chamber  = nullptr;
     m_acceptor = nullptr;
 
+    m_acceptors.clear();
+
     // Be ready to restart the actor.
     m_asio->reset();
 
     // Mark this service's port as free.
     m_context.mapper.retain(m_prototype->name());
 }
+
+tcp::endpoint
+actor_t::local_endpoint() const {
+    return m_acceptor ? m_acceptor->local_endpoint() : m_acceptors.front()->local_endpoint();
+}
@@ -20,7 +20,11 @@
 
 #include "cocaine/detail/chamber.hpp"
 
+#include "cocaine/exceptions.hpp"
+
 #if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
     #include <sys/prctl.h>
 #elif defined(__APPLE__)
     #include <pthread.h>
@@ -131,24 +135,168 @@ chamber_t::stats_periodic_action_t::finalize(const std::error_code& ec) {
     operator()();
 }
 
+// Measures the scheduling lag: once in a while, a probe is posted into the reactor queue, and the
+// time it took for the reactor to actually run it is recorded.
+
+class chamber_t::lag_periodic_action_t:
+    public std::enable_shared_from_this<lag_periodic_action_t>
+{
+#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
+    typedef std::chrono::steady_clock clock_type;
+#else
+    typedef std::chrono::monotonic_clock clock_type;
+#endif
+
+    const std::weak_ptr<lag_state_t> state;
+    const boost::posix_time::milliseconds interval;
+
+    // When the current probe has been posted.
+    clock_type::time_point posted;
+
+public:
+    template<class Interval>
+    lag_periodic_action_t(chamber_t *const parent, Interval interval_):
+        state(parent->lag_state),
+        interval(interval_)
+    { }
+
+    void
+    operator()();
+
+private:
+    void
+    post(const std::error_code& ec);
+
+    void
+    finalize();
+};
+
+void
+chamber_t::lag_periodic_action_t::operator()() {
+    const auto ptr = state.lock();
+
+    if(!ptr || ptr->stopped) {
+        return;
+    }
+
+    ptr->probe.expires_from_now(interval);
+
+    ptr->probe.async_wait(std::bind(&lag_periodic_action_t::post,
+        shared_from_this(),
+        std::placeholders::_1
+    ));
+}
+
+void
+chamber_t::lag_periodic_action_t::post(const std::error_code& ec) {
+    const auto ptr = state.lock();
+
+    if(ec == asio::error::operation_aborted || !ptr) {
+        return;
+    }
+
+    posted = clock_type::now();
+
+    ptr->probe.get_io_service().post(std::bind(&lag_periodic_action_t::finalize,
+        shared_from_this()
+    ));
+}
+
+void
+chamber_t::lag_periodic_action_t::finalize() {
+    const auto ptr = state.lock();
+
+    if(!ptr) {
+        // The chamber is gone, and the reactor has been restarted since.
+        return;
+    }
+
+    const uint64_t lag = std::chrono::duration_cast<std::chrono::microseconds>(
+        clock_type::now() - posted
+    ).count();
+
+    (*ptr->mean.synchronize())(static_cast<double>(lag));
+
+    ptr->histogram.record(lag);
+
+    operator()();
+}
+
 // Chamber
 
 namespace bpt = boost::posix_time;
 
-chamber_t::chamber_t(const std::string& name_, const std::shared_ptr<asio::io_service>& asio_):
+chamber_t::lag_state_t::lag_state_t(asio::io_service& asio):
+    probe(asio),
+    stopped(false),
+    mean(boost::accumulators::rolling_window_size = kProbeWindow)
+{ }
+
+chamber_t::chamber_t(const std::string& name_, const std::shared_ptr<asio::io_service>& asio_,
+                     const std::vector<unsigned int>& cpus_)
+:
     name(name_),
     asio(asio_),
+    cpus(cpus_),
     cron(*asio_),
-    load_acc1(boost::accumulators::rolling_window_size = 60 / kCollectionInterval)
+    load_acc1(boost::accumulators::rolling_window_size = 60 / kCollectionInterval),
+    lag_state(std::make_shared<lag_state_t>(*asio_))
 {
     asio->post(std::bind(&stats_periodic_action_t::operator(),
         std::make_shared<stats_periodic_action_t>(this, bpt::seconds(kCollectionInterval))
     ));
 
-    // Bootstrap the rolling mean to avoid showing NaNs to the first clients.
+    asio->post(std::bind(&lag_periodic_action_t::operator(),
+        std::make_shared<lag_periodic_action_t>(this, bpt::milliseconds(kProbeInterval))
+    ));
+
+    // Bootstrap the rolling means to avoid showing NaNs to the first clients.
     (*load_acc1.synchronize())(0.0f);
+    (*lag_state->mean.synchronize())(0.0f);
 
     thread = std::make_unique<boost::thread>(named_runnable_t(name, asio));
+
+    if(cpus.empty()) {
+        return;
+    }
+
+    // The thread is pinned before it gets any work, so that everything it allocates for sessions,
+    // like receive rings and encoder buffers, is first touched and thus placed on the local node.
+    try {
+        pin();
+    } catch(...) {
+        asio->stop();
+        thread->join();
+
+        // Leave the reactor reusable for the owner, just like a normal termination does.
+        asio->reset();
+
+        throw;
+    }
+}
+
+void
+chamber_t::pin() {
+#if defined(__linux__)
+    cpu_set_t set;
+
+    CPU_ZERO(&set);
+
+    for(auto it = cpus.begin(); it != cpus.end(); ++it) {
+        if(*it >= CPU_SETSIZE) {
+            throw cocaine::error_t("CPU %d is out of range", *it);
+        }
+
+        CPU_SET(*it, &set);
+    }
+
+    if(const int rv = ::pthread_setaffinity_np(thread->native_handle(), sizeof(set), &set)) {
+        std::error_code ec(rv, std::system_category());
+        throw cocaine::error_t("unable to set the thread affinity - [%d] %s", ec.value(), ec.message());
+    }
+#else
+    throw cocaine::error_t("CPU affinity is not supported on this platform");
+#endif
 }
 
 namespace {
@@ -157,19 +305,36 @@ struct cancel_action_t {
     void
     operator()();
 
-    // Never becomes a dangling reference.
+    // Never become dangling references, as long as the reactor is running.
     asio::deadline_timer& cron;
+    asio::deadline_timer& probe;
+
+    // Keeps a probe which is already in the reactor queue from rescheduling itself.
+    bool& stopped;
 };
 
 void
 cancel_action_t::operator()() {
+    stopped = true;
+
     cron.cancel();
+    probe.cancel();
 }
 
 } // namespace
 
 chamber_t::~chamber_t() {
-    asio->post(cancel_action_t{cron});
+    cancel_action_t cancel = { cron, lag_state->probe, lag_state->stopped };
+
+    if(asio->stopped()) {
+        // The owner has stopped the reactor, so nothing would run the cancellation, and it would be
+        // left in the queue with dangling references until the reactor is restarted. The thread is
+        // exiting anyway, so the timers are cancelled right here, after it's done.
+        thread->join();
+        return cancel();
+    }
+
+    asio->post(cancel);
 
     // NOTE: This might hang forever if io_service users have failed to abort their async operations
     // upon context.signals.shutdown signal (or haven't connected to it at all).
@@ -36,8 +36,11 @@
 
 #include "cocaine/logging.hpp"
 
+#include "cocaine/rpc/metrics.hpp"
+
 #include <numeric>
 #include <random>
+#include <sstream>
 
 #include <blackhole/formatter/json.hpp>
 #include <blackhole/frontend/files.hpp>
@@ -49,10 +52,13 @@
 #include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 
+#include <boost/lexical_cast.hpp>
+
 #include <boost/spirit/include/karma_char.hpp>
 #include <boost/spirit/include/karma_generate.hpp>
 #include <boost/spirit/include/karma_list.hpp>
 #include <boost/spirit/include/karma_string.hpp>
+#include <boost/spirit/include/karma_uint.hpp>
 
 #include <asio/io_service.hpp>
 #include <asio/ip/host_name.hpp>
@@ -208,6 +214,99 @@ private:
     fs::ifstream* m_backend;
 };
 
+// Parses CPU lists in the kernel format, e.g. "0-3,8,10-11".
+std::vector<unsigned int>
+parse_cpulist(const std::string& cpulist) {
+    std::vector<unsigned int> cpus;
+    std::istringstream stream(cpulist);
+
+    for(std::string range; std::getline(stream, range, ',');) {
+        unsigned int first, last;
+        char dash;
+
+        std::istringstream parser(range);
+
+        if(!(parser >> first)) {
+            throw cocaine::error_t("invalid CPU list '%s'", cpulist);
+        }
+
+        if(parser >> dash) {
+            if(dash != '-' || !(parser >> last) || last < first) {
+                throw cocaine::error_t("invalid CPU list '%s'", cpulist);
+            }
+        } else {
+            last = first;
+        }
+
+        for(unsigned int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+
+    if(cpus.empty()) {
+        throw cocaine::error_t("invalid CPU list '%s'", cpulist);
+    }
+
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+
+    return cpus;
+}
+
+std::string
+format_cpulist(const std::vector<unsigned int>& cpus) {
+    std::ostringstream stream;
+    std::ostream_iterator<char> builder(stream);
+
+    boost::spirit::karma::generate(builder, boost::spirit::karma::uint_ % ",", cpus);
+
+    return stream.str();
+}
+
+// Discovers the CPU set of every NUMA node in the system, ordered by the node number.
+std::vector<std::vector<unsigned int>>
+numa_cpusets() {
+    const fs::path root("/sys/devices/system/node");
+
+    std::map<unsigned int, std::vector<unsigned int>> nodes;
+
+    if(!fs::exists(root)) {
+        throw cocaine::error_t("NUMA topology is not available on this system");
+    }
+
+    for(fs::directory_iterator it(root), end; it != end; ++it) {
+        const std::string name = it->path().filename().string();
+
+        if(name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+           name.find_first_not_of("0123456789", 4) != std::string::npos)
+        {
+            continue;
+        }
+
+        fs::ifstream stream(it->path() / "cpulist");
+        std::string cpulist;
+
+        // Memory-only nodes have no CPUs at all.
+        if(!std::getline(stream, cpulist) || cpulist.empty()) {
+            continue;
+        }
+
+        nodes[boost::lexical_cast<unsigned int>(name.substr(4))] = parse_cpulist(cpulist);
+    }
+
+    if(nodes.empty()) {
+        throw cocaine::error_t("NUMA topology is not available on this system");
+    }
+
+    std::vector<std::vector<unsigned int>> cpusets;
+
+    for(auto it = nodes.begin(); it != nodes.end(); ++it) {
+        cpusets.push_back(it->second);
+    }
+
+    return cpusets;
+}
+
 } // namespace
 
 namespace cocaine {
@@ -352,6 +451,9 @@ config_t::config_t(const std::string& source) {
         throw cocaine::error_t("network I/O pool size must be positive");
     }
 
+    network.reuseport = network_config.at("reuseport", false).as_bool();
+    network.metrics   = network_config.at("metrics",   false).as_bool();
+
     if(network_config.count("pinned")) {
         network.ports.pinned = network_config.at("pinned").to<decltype(network.ports.pinned)>();
     }
@@ -360,6 +462,60 @@ config_t::config_t(const std::string& source) {
         network.ports.shared = network_config.at("shared").to<decltype(network.ports.shared)>();
     }
 
+    if(network_config.count("batching")) {
+        const auto batching_config = network_config.at("batching").as_object();
+
+        network.batching.buffers = batching_config.at("buffers", defaults::batch_buffers).as_uint();
+        network.batching.bytes   = batching_config.at("bytes",   defaults::batch_bytes  ).as_uint();
+
+        if(network.batching.buffers == 0 || network.batching.bytes == 0) {
+            throw cocaine::error_t("write batching limits must be positive");
+        }
+    } else {
+        network.batching.buffers = 0;
+        network.batching.bytes   = 0;
+    }
+
+    const auto ring_config = network_config.at("ring", dynamic_t::object_t()).as_object();
+
+    network.ring.initial = ring_config.at("initial", defaults::ring_initial_size).as_uint();
+    network.ring.maximum = ring_config.at("maximum", defaults::ring_maximum_size).as_uint();
+
+    if(network.ring.initial == 0) {
+        throw cocaine::error_t("receive buffer size must be positive");
+    }
+
+    const auto watermarks_config = network_config.at("watermarks", dynamic_t::object_t()).as_object();
+
+    network.watermarks.high = watermarks_config.at("high", 0U).as_uint();
+    network.watermarks.low  = watermarks_config.at("low", network.watermarks.high / 2).as_uint();
+
+    if(network.watermarks.low > network.watermarks.high) {
+        throw cocaine::error_t("low watermark must not exceed the high watermark");
+    }
+
+    const auto affinity_config = network_config.at("affinity", dynamic_t::object_t()).as_object();
+
+    if(affinity_config.count("units")) {
+        const auto units = affinity_config.at("units");
+
+        if(units.is_string() && units.as_string() == "numa") {
+            network.affinity.units = numa_cpusets();
+        } else if(units.is_array()) {
+            const auto& cpulists = units.as_array();
+
+            for(auto it = cpulists.begin(); it != cpulists.end(); ++it) {
+                network.affinity.units.push_back(parse_cpulist(it->as_string()));
+            }
+        } else {
+            throw cocaine::error_t("execution unit affinity must be either 'numa' or a list of CPU lists");
+        }
+    }
+
+    if(affinity_config.count("services")) {
+        network.affinity.services = parse_cpulist(affinity_config.at("services").as_string());
+    }
+
     // Blackhole logging configuration
     logging = root.as_object().at("logging",  dynamic_t::empty_object).to<config_t::logging_t>();
 
@@ -649,11 +805,37 @@ context_t::locate(const std::string& name) const {
 
 namespace {
 
+// The rolling CPU utilization is too slow to react to bursts of incoming connections, so the unit
+// with the least number of sessions is picked, with the utilization used only to break ties. Units
+// whose reactors are lagging behind are avoided regardless of their session count, because a few
+// heavy sessions hurt the latency of every other session on the unit much more than many idle ones.
+
 struct utilization_t {
     typedef std::unique_ptr<execution_unit_t> value_type;
 
+    // Recent mean scheduling lag in microseconds, which is considered as overload.
+    static const unsigned int kLagThreshold = 1000;
+
     bool
     operator()(const value_type& lhs, const value_type& rhs) const {
+        const double lhs_lag = lhs->lag(), rhs_lag = rhs->lag();
+
+        const bool lhs_lagging = lhs_lag > kLagThreshold, rhs_lagging = rhs_lag > kLagThreshold;
+
+        if(lhs_lagging != rhs_lagging) {
+            return rhs_lagging;
+        }
+
+        if(lhs_lagging) {
+            return lhs_lag < rhs_lag;
+        }
+
+        const size_t lhs_load = lhs->load(), rhs_load = rhs->load();
+
+        if(lhs_load != rhs_load) {
+            return lhs_load < rhs_load;
+        }
+
         return lhs->utilization() < rhs->utilization();
     }
 };
@@ -665,6 +847,11 @@ context_t::engine() {
     return **std::min_element(m_pool.begin(), m_pool.end(), utilization_t());
 }
 
+const std::vector<std::unique_ptr<execution_unit_t>>&
+context_t::pool() const {
+    return m_pool;
+}
+
 void
 context_t::bootstrap() {
     blackhole::scoped_attributes_t guard(*m_logger, blackhole::attribute::set_t({
@@ -673,6 +860,9 @@ context_t::bootstrap() {
 
     COCAINE_LOG_INFO(m_logger, "initializing the core");
 
+    // Must be set before any service is created, because prototypes are instrumented by their actors.
+    io::enable_metrics(config.network.metrics);
+
     m_repository = std::make_unique<api::repository_t>(*m_logger);
 
 #ifdef COCAINE_ALLOW_RAFT
@@ -687,8 +877,26 @@ context_t::bootstrap() {
 
     COCAINE_LOG_INFO(m_logger, "starting %d execution unit(s)", config.network.pool);
 
+    const auto& cpusets = config.network.affinity.units;
+
     while(m_pool.size() != config.network.pool) {
-        m_pool.emplace_back(std::make_unique<execution_unit_t>(*this));
+        std::vector<unsigned int> cpus;
+
+        if(!cpusets.empty()) {
+            cpus = cpusets[m_pool.size() % cpusets.size()];
+        }
+
+        m_pool.emplace_back(std::make_unique<execution_unit_t>(*this, cpus));
+
+        if(!cpus.empty()) {
+            COCAINE_LOG_INFO(m_logger, "execution unit %d is pinned to CPU(s) %s", m_pool.size() - 1,
+                format_cpulist(cpus));
+        }
+    }
+
+    if(!config.network.affinity.services.empty()) {
+        COCAINE_LOG_INFO(m_logger, "service threads are pinned to CPU(s) %s",
+            format_cpulist(config.network.affinity.services));
     }
 
     COCAINE_LOG_INFO(m_logger, "starting %d service(s)", config.services.size());
@@ -31,6 +31,8 @@ const unsigned long defaults::concurrency      = 10L;
 const unsigned long defaults::crashlog_limit   = 50L;
 const unsigned long defaults::pool_limit       = 10L;
 const unsigned long defaults::queue_limit      = 100L;
+const unsigned long defaults::warm_pool        = 0L;
+const unsigned long defaults::pool_minimum     = 0L;
 
 const float defaults::control_timeout          = 5.0f;
 
@@ -38,6 +40,10 @@ const std::string defaults::plugins_path       = "/usr/lib/cocaine";
 const std::string defaults::runtime_path       = "/var/run/cocaine";
 
 const std::string defaults::endpoint           = "::";
+const unsigned long defaults::batch_buffers    = 64L;
+const unsigned long defaults::batch_bytes      = 1048576L;
+const unsigned long defaults::ring_initial_size = 65536L;
+const unsigned long defaults::ring_maximum_size = 0L;
 
 const std::string defaults::log_verbosity      = "info";
 const std::string defaults::log_timestamp      = "%Y-%m-%d %H:%M:%S.%f";
@@ -20,6 +20,8 @@
 
 #include "cocaine/rpc/dispatch.hpp"
 
+#include "cocaine/dynamic.hpp"
+
 using namespace cocaine::io;
 
 basic_dispatch_t::basic_dispatch_t(const std::string& name):
@@ -39,3 +41,32 @@ std::string
 basic_dispatch_t::name() const {
     return m_name;
 }
+
+void
+basic_dispatch_t::instrument() const {
+    // Empty.
+}
+
+dynamic_t
+basic_dispatch_t::metrics() const {
+    dynamic_t::object_t result;
+
+    const auto& basis = graph();
+
+    for(auto it = basis.begin(); it != basis.end(); ++it) {
+        const auto ptr = slot_metrics(it->first);
+
+        if(ptr == nullptr || ptr->calls == 0) {
+            continue;
+        }
+
+        result[std::get<0>(it->second)] = ptr->info();
+    }
+
+    return result;
+}
+
+const slot_metrics_t*
+basic_dispatch_t::slot_metrics(int COCAINE_UNUSED_(id)) const {
+    return nullptr;
+}
@@ -0,0 +1,205 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/rpc/asio/encoder.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include <boost/thread/tss.hpp>
+
+using namespace cocaine::io;
+using namespace cocaine::io::aux;
+
+namespace {
+
+// Thread-local cache of encoding buffers. Buffers are split into power-of-two size classes from 2KB
+// up to 1MB, every class caching at most 1MB worth of buffers, but no less than a few of them. The
+// larger buffers are allocated and freed directly.
+
+class buffer_pool_t {
+    COCAINE_DECLARE_NONCOPYABLE(buffer_pool_t)
+
+    static const size_t kMinClassOrder = 11;
+    static const size_t kMaxClassOrder = 20;
+
+    static const size_t kMaxCachedBytes   = 1 << kMaxClassOrder;
+    static const size_t kMinCachedBuffers = 4;
+
+    std::array<std::vector<char*>, kMaxClassOrder - kMinClassOrder + 1> m_classes;
+
+public:
+    buffer_pool_t() { }
+
+   ~buffer_pool_t();
+
+    auto
+    acquire(size_t& capacity) -> char*;
+
+    void
+    release(char* blob, size_t capacity);
+
+private:
+    static
+    size_t
+    order(size_t capacity);
+};
+
+buffer_pool_t::~buffer_pool_t() {
+    for(auto it = m_classes.begin(); it != m_classes.end(); ++it) {
+        for(auto blob = it->begin(); blob != it->end(); ++blob) {
+            delete[] *blob;
+        }
+    }
+}
+
+size_t
+buffer_pool_t::order(size_t capacity) {
+    size_t result = kMinClassOrder;
+
+    while((static_cast<size_t>(1) << result) < capacity) {
+        result++;
+    }
+
+    return result;
+}
+
+char*
+buffer_pool_t::acquire(size_t& capacity) {
+    const size_t class_order = order(capacity);
+
+    if(class_order > kMaxClassOrder) {
+        return new char[capacity];
+    }
+
+    capacity = static_cast<size_t>(1) << class_order;
+
+    auto& cache = m_classes[class_order - kMinClassOrder];
+
+    if(cache.empty()) {
+        return new char[capacity];
+    }
+
+    char* blob = cache.back();
+
+    cache.pop_back();
+
+    return blob;
+}
+
+void
+buffer_pool_t::release(char* blob, size_t capacity) {
+    const size_t class_order = order(capacity);
+
+    if(class_order > kMaxClassOrder) {
+        delete[] blob;
+        return;
+    }
+
+    auto& cache = m_classes[class_order - kMinClassOrder];
+
+    if(cache.size() * capacity >= kMaxCachedBytes && cache.size() >= kMinCachedBuffers) {
+        delete[] blob;
+        return;
+    }
+
+    cache.push_back(blob);
+}
+
+boost::thread_specific_ptr<buffer_pool_t> pool;
+
+buffer_pool_t&
+local_pool() {
+    if(!pool.get()) {
+        pool.reset(new buffer_pool_t());
+    }
+
+    return *pool;
+}
+
+} // namespace
+
+encoded_buffers_t::~encoded_buffers_t() {
+    if(blob) {
+        local_pool().release(blob, capacity);
+    }
+}
+
+void
+encoded_buffers_t::reserve(size_t size) {
+    if(size <= capacity) {
+        return;
+    }
+
+    // Keep the doubling growth pattern for buffers which are being written incrementally.
+    size = std::max(size, std::max(capacity * 2, static_cast<size_t>(kInitialBufferSize)));
+
+    char* target = local_pool().acquire(size);
+
+    if(blob) {
+        std::memcpy(target, blob, offset);
+        local_pool().release(blob, capacity);
+    }
+
+    blob     = target;
+    capacity = size;
+}
+
+encoded_buffers_t::encoded_buffers_t(encoded_buffers_t&& other):
+    blob(other.blob),
+    capacity(other.capacity),
+    offset(other.offset),
+    segments(std::move(other.segments)),
+    attached(other.attached)
+{
+    other.blob     = nullptr;
+    other.capacity = 0;
+    other.offset   = 0;
+    other.attached = 0;
+
+    other.segments.clear();
+}
+
+encoded_buffers_t&
+encoded_buffers_t::operator=(encoded_buffers_t&& other) {
+    if(this == &other) {
+        return *this;
+    }
+
+    if(blob) {
+        local_pool().release(blob, capacity);
+    }
+
+    blob     = other.blob;
+    capacity = other.capacity;
+    offset   = other.offset;
+    segments = std::move(other.segments);
+    attached = other.attached;
+
+    other.blob     = nullptr;
+    other.capacity = 0;
+    other.offset   = 0;
+    other.attached = 0;
+
+    other.segments.clear();
+
+    return *this;
+}
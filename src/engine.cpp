@@ -21,6 +21,7 @@
 #include "cocaine/detail/engine.hpp"
 
 #include "cocaine/context.hpp"
+#include "cocaine/dynamic.hpp"
 #include "cocaine/logging.hpp"
 
 #include "cocaine/detail/chamber.hpp"
@@ -37,9 +38,11 @@ using namespace asio::ip;
 
 using namespace cocaine;
 
-execution_unit_t::execution_unit_t(context_t& context):
+execution_unit_t::execution_unit_t(context_t& context, const std::vector<unsigned int>& cpus):
+    m_context(context),
+    m_load(0),
     m_asio(new io_service()),
-    m_chamber(new io::chamber_t("core:asio", m_asio))
+    m_chamber(new io::chamber_t("core:asio", m_asio, cpus))
 {
     m_log = context.log("core:asio", {
         attribute::make("engine", boost::lexical_cast<std::string>(m_chamber->uuid()))
@@ -48,8 +51,159 @@ execution_unit_t::execution_unit_t(context_t& context):
     COCAINE_LOG_DEBUG(m_log, "engine started");
 }
 
+// Execution unit internals
+
+class execution_unit_t::accept_action_t:
+    public std::enable_shared_from_this<accept_action_t>
+{
+    execution_unit_t *const parent;
+
+    const std::shared_ptr<tcp::acceptor> acceptor;
+    const io::dispatch_ptr_t dispatch;
+
+    tcp::socket socket;
+
+public:
+    accept_action_t(execution_unit_t *const parent_, const std::shared_ptr<tcp::acceptor>& acceptor_,
+                    const io::dispatch_ptr_t& dispatch_)
+    :
+        parent(parent_),
+        acceptor(acceptor_),
+        dispatch(dispatch_),
+        socket(*parent->m_asio)
+    { }
+
+    void
+    operator()();
+
+private:
+    void
+    finalize(const std::error_code& ec);
+};
+
+void
+execution_unit_t::accept_action_t::operator()() {
+    acceptor->async_accept(socket, std::bind(&accept_action_t::finalize,
+        shared_from_this(),
+        std::placeholders::_1
+    ));
+}
+
+void
+execution_unit_t::accept_action_t::finalize(const std::error_code& ec) {
+    auto ptr = std::make_unique<tcp::socket>(std::move(socket));
+
+    if(ec) {
+        if(ec == asio::error::operation_aborted) {
+            return;
+        }
+
+        COCAINE_LOG_ERROR(parent->m_log, "unable to accept a connection: [%d] %s", ec.value(), ec.message())(
+            "service", dispatch->name()
+        );
+    } else {
+        parent->m_load++;
+
+        // The connection has been accepted right in this reactor, so no need to clone the socket.
+        parent->start(std::move(ptr), dispatch);
+    }
+
+    operator()();
+}
+
+class execution_unit_t::inspect_action_t {
+    execution_unit_t *const parent;
+
+    const std::function<void(const dynamic_t&)> handler;
+
+    // Used to measure the scheduling lag.
+    const clock_type::time_point posted;
+
+public:
+    inspect_action_t(execution_unit_t *const parent_,
+                     const std::function<void(const dynamic_t&)>& handler_)
+    :
+        parent(parent_),
+        handler(handler_),
+        posted(clock_type::now())
+    { }
+
+    void
+    operator()() const;
+};
+
+void
+execution_unit_t::inspect_action_t::operator()() const {
+    const auto now = clock_type::now();
+
+    dynamic_t::array_t sessions;
+
+    for(auto it = parent->m_sessions.begin(); it != parent->m_sessions.end(); ++it) {
+        const auto stats = it->second->stats();
+
+        auto& sample = parent->m_samples[it->first];
+
+        const double elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+            now - sample.stamp
+        ).count();
+
+        dynamic_t::object_t pending, rates, session;
+
+        pending["read" ] = dynamic_t::uint_t(stats.pending_read);
+        pending["write"] = dynamic_t::uint_t(stats.pending_write);
+
+        if(elapsed > 0) {
+            rates["received"] = dynamic_t::double_t((stats.received - sample.received) / elapsed);
+            rates["sent"    ] = dynamic_t::double_t((stats.sent     - sample.sent)     / elapsed);
+        }
+
+        session["endpoint"] = boost::lexical_cast<std::string>(it->second->remote_endpoint());
+        session["service" ] = it->second->name();
+        session["channels"] = dynamic_t::uint_t(stats.channels);
+        session["pending" ] = pending;
+        session["received"] = dynamic_t::uint_t(stats.received);
+        session["sent"    ] = dynamic_t::uint_t(stats.sent);
+        session["rates"   ] = rates;
+
+        sessions.push_back(session);
+
+        sample.received = stats.received;
+        sample.sent     = stats.sent;
+        sample.stamp    = now;
+    }
+
+    dynamic_t::array_t affinity;
+
+    for(auto it = parent->affinity().begin(); it != parent->affinity().end(); ++it) {
+        affinity.push_back(dynamic_t::uint_t(*it));
+    }
+
+    dynamic_t::object_t result;
+
+    result["affinity"   ] = affinity;
+    result["utilization"] = dynamic_t::double_t(parent->utilization());
+    result["load"       ] = dynamic_t::uint_t(parent->load());
+    result["sessions"   ] = sessions;
+
+    dynamic_t::object_t lag = parent->m_chamber->lag().info().as_object();
+
+    // Recent mean scheduling lag, and the time this very request has spent in the reactor queue.
+    lag["recent"] = dynamic_t::double_t(parent->lag());
+    lag["inspection"] = dynamic_t::uint_t(std::chrono::duration_cast<std::chrono::microseconds>(
+        now - posted
+    ).count());
+
+    result["lag"] = lag;
+
+    handler(result);
+}
+
 namespace {
 
+#if defined(SO_REUSEPORT)
+typedef asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT> reuse_port;
+#endif
+
 struct detach_action_t {
     void
     operator()();
@@ -81,6 +235,10 @@ execution_unit_t::~execution_unit_t() {
 
 void
 execution_unit_t::attach(const std::shared_ptr<tcp::socket>& ptr, const io::dispatch_ptr_t& dispatch) {
+    // Account the session right away, so that it's not placed on this unit just because the reactor
+    // hasn't processed the previous ones yet.
+    m_load++;
+
     m_asio->dispatch(std::bind(&execution_unit_t::attach_impl, this, ptr, dispatch));
 }
 
@@ -89,6 +247,49 @@ execution_unit_t::utilization() const {
     return m_chamber->load_avg1();
 }
 
+double
+execution_unit_t::lag() const {
+    return m_chamber->lag_avg();
+}
+
+const std::vector<unsigned int>&
+execution_unit_t::affinity() const {
+    return m_chamber->affinity();
+}
+
+size_t
+execution_unit_t::load() const {
+    return m_load;
+}
+
+void
+execution_unit_t::inspect(const std::function<void(const dynamic_t&)>& handler) {
+    m_asio->post(inspect_action_t(this, handler));
+}
+
+std::shared_ptr<tcp::acceptor>
+execution_unit_t::listen(const tcp::endpoint& endpoint, const io::dispatch_ptr_t& dispatch) {
+    auto acceptor = std::make_shared<tcp::acceptor>(*m_asio);
+
+    acceptor->open(endpoint.protocol());
+    acceptor->set_option(tcp::acceptor::reuse_address(true));
+
+#if defined(SO_REUSEPORT)
+    acceptor->set_option(reuse_port(true));
+#else
+    throw cocaine::error_t("SO_REUSEPORT is not supported on this platform");
+#endif
+
+    acceptor->bind(endpoint);
+    acceptor->listen();
+
+    m_asio->post(std::bind(&accept_action_t::operator(),
+        std::make_shared<accept_action_t>(this, acceptor, dispatch)
+    ));
+
+    return acceptor;
+}
+
 void
 execution_unit_t::attach_impl(const std::shared_ptr<tcp::socket>& ptr, const io::dispatch_ptr_t& dispatch) {
     int socket;
@@ -96,29 +297,52 @@ execution_unit_t::attach_impl(const std::shared_ptr<tcp::socket>& ptr, const io:
     if((socket = ::dup(ptr->native_handle())) == -1) {
         std::error_code ec(errno, std::system_category());
         COCAINE_LOG_ERROR(m_log, "unable to clone client's socket - [%d] %s", ec.value(), ec.message());
+        m_load--;
         return;
     }
 
+    // Copy the socket into the new reactor.
+    start(std::make_unique<tcp::socket>(*m_asio, ptr->local_endpoint().protocol(), socket), dispatch);
+}
+
+void
+execution_unit_t::start(std::unique_ptr<tcp::socket> ptr, const io::dispatch_ptr_t& dispatch) {
+    const int socket = ptr->native_handle();
+
     // Make sure that the fd wasn't reused before it was actually processed for disconnection.
     BOOST_ASSERT(!m_sessions.count(socket));
 
-    // Copy the socket into the new reactor.
-    auto channel = std::make_unique<io::channel<tcp>>(std::make_unique<tcp::socket>(
-       *m_asio,
-        ptr->local_endpoint().protocol(),
-        socket
-    ));
+    auto channel = std::make_unique<io::channel<tcp>>(std::move(ptr));
 
     // Set the NO_DELAY TCP option to speed up small message passing.
     channel->socket->set_option(tcp::no_delay(true));
 
+    channel->reader->bounds(
+        m_context.config.network.ring.initial,
+        m_context.config.network.ring.maximum
+    );
+
+    channel->writer->coalesce(
+        m_context.config.network.batching.buffers,
+        m_context.config.network.batching.bytes
+    );
+
     try {
         m_sessions[socket] = std::make_shared<session_t>(std::move(channel), dispatch);
     } catch(const asio::system_error& e) {
         COCAINE_LOG_ERROR(m_log, "client has disappeared while creating session");
+        m_load--;
         return;
     }
 
+    // Message rates are calculated since the session has been started, until the first inspection.
+    m_samples[socket] = sample_t{0, 0, clock_type::now()};
+
+    m_sessions.at(socket)->watermarks(
+        m_context.config.network.watermarks.high,
+        m_context.config.network.watermarks.low
+    );
+
     // Bind the shutdown signals.
     m_sessions.at(socket)->signals.shutdown.connect(std::bind(&execution_unit_t::on_shutdown,
         this,
@@ -126,7 +350,7 @@ execution_unit_t::attach_impl(const std::shared_ptr<tcp::socket>& ptr, const io:
         socket
     ));
 
-    COCAINE_LOG_DEBUG(m_log, "attached client to engine with %.2f%% utilization", utilization() * 100)(
+    COCAINE_LOG_DEBUG(m_log, "attached client to engine with %.2f%% utilization, %d sessions", utilization() * 100, load())(
         "endpoint", m_sessions.at(socket)->remote_endpoint(),
         "service",  m_sessions.at(socket)->name()
     );
@@ -141,9 +365,13 @@ execution_unit_t::on_shutdown(const std::error_code& ec, int socket) {
 
     BOOST_ASSERT(ec && it != m_sessions.end());
 
+    const auto stats = it->second->write_stats();
+
     scoped_attributes_t attributes(*m_log, {
         attribute::make("endpoint", boost::lexical_cast<std::string>(it->second->remote_endpoint())),
-        attribute::make("service",  it->second->name())
+        attribute::make("service",  it->second->name()),
+        attribute::make("messages", stats.messages),
+        attribute::make("syscalls", stats.syscalls)
     });
 
     if(ec != asio::error::eof) {
@@ -154,4 +382,7 @@ execution_unit_t::on_shutdown(const std::error_code& ec, int socket) {
 
     it->second->detach();
     m_sessions.erase(it);
+    m_samples.erase(socket);
+
+    m_load--;
 }
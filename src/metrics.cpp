@@ -0,0 +1,187 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/rpc/metrics.hpp"
+
+#include "cocaine/dynamic.hpp"
+
+using namespace cocaine;
+using namespace cocaine::io;
+
+namespace {
+
+std::atomic<bool> enabled(false);
+
+size_t
+bucket_of(uint64_t value) {
+    size_t bucket = 0;
+
+    while(value != 0) {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+} // namespace
+
+bool
+cocaine::io::metrics_enabled() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void
+cocaine::io::enable_metrics(bool enabled_) {
+    enabled.store(enabled_, std::memory_order_relaxed);
+}
+
+// Histogram
+
+histogram_t::histogram_t():
+    m_sum(0),
+    m_max(0)
+{
+    for(auto it = m_buckets.begin(); it != m_buckets.end(); ++it) {
+        it->store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+histogram_t::record(uint64_t value) {
+    m_buckets[std::min(bucket_of(value), m_buckets.size() - 1)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t max = m_max.load(std::memory_order_relaxed);
+
+    while(value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+        // Retry.
+    }
+}
+
+uint64_t
+histogram_t::count() const {
+    uint64_t result = 0;
+
+    for(auto it = m_buckets.begin(); it != m_buckets.end(); ++it) {
+        result += it->load(std::memory_order_relaxed);
+    }
+
+    return result;
+}
+
+uint64_t
+histogram_t::percentile(double quantile) const {
+    const uint64_t total = count();
+
+    if(total == 0) {
+        return 0;
+    }
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(quantile * total + 0.5));
+
+    uint64_t seen = 0;
+
+    for(size_t i = 0; i < m_buckets.size(); ++i) {
+        if((seen += m_buckets[i].load(std::memory_order_relaxed)) >= rank) {
+            return std::min<uint64_t>((uint64_t(1) << i) - 1, m_max.load(std::memory_order_relaxed));
+        }
+    }
+
+    return m_max.load(std::memory_order_relaxed);
+}
+
+dynamic_t
+histogram_t::info() const {
+    const uint64_t total = count();
+
+    dynamic_t::object_t result;
+
+    result["count"] = dynamic_t::uint_t(total);
+    result["mean" ] = dynamic_t::uint_t(total ? m_sum.load() / total : 0);
+    result["max"  ] = dynamic_t::uint_t(m_max.load());
+
+    result["p50"  ] = dynamic_t::uint_t(percentile(0.50));
+    result["p90"  ] = dynamic_t::uint_t(percentile(0.90));
+    result["p99"  ] = dynamic_t::uint_t(percentile(0.99));
+    result["p999" ] = dynamic_t::uint_t(percentile(0.999));
+
+    return result;
+}
+
+// Slot metrics
+
+slot_metrics_t::slot_metrics_t():
+    calls(0),
+    errors(0),
+    bytes(0)
+{ }
+
+dynamic_t
+slot_metrics_t::info() const {
+    dynamic_t::object_t result;
+
+    result["calls"    ] = dynamic_t::uint_t(calls.load());
+    result["errors"   ] = dynamic_t::uint_t(errors.load());
+    result["bytes"    ] = dynamic_t::uint_t(bytes.load());
+    result["unpacking"] = unpacking.info();
+    result["execution"] = execution.info();
+
+    return result;
+}
+
+namespace {
+
+uint64_t
+elapsed(slot_metrics_t::clock_type::time_point& stamp) {
+    const auto now = slot_metrics_t::clock_type::now();
+    const auto result = std::chrono::duration_cast<std::chrono::microseconds>(now - stamp).count();
+
+    stamp = now;
+
+    return result;
+}
+
+} // namespace
+
+slot_metrics_t::timer_t::timer_t(slot_metrics_t& metrics_):
+    metrics(metrics_),
+    stamp(clock_type::now()),
+    completed(false)
+{
+    metrics.calls.fetch_add(1, std::memory_order_relaxed);
+}
+
+slot_metrics_t::timer_t::~timer_t() {
+    if(!completed) {
+        metrics.errors.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void
+slot_metrics_t::timer_t::unpacked() {
+    metrics.unpacking.record(elapsed(stamp));
+}
+
+void
+slot_metrics_t::timer_t::complete() {
+    metrics.execution.record(elapsed(stamp));
+    completed = true;
+}
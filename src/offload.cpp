@@ -0,0 +1,172 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/rpc/offload.hpp"
+
+#include "cocaine/dynamic.hpp"
+
+#include <chrono>
+
+using namespace cocaine;
+using namespace cocaine::io;
+
+namespace {
+
+#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
+typedef std::chrono::steady_clock clock_type;
+#else
+typedef std::chrono::monotonic_clock clock_type;
+#endif
+
+struct run_action_t {
+    void
+    operator()() const {
+        asio.run();
+    }
+
+    asio::io_service& asio;
+};
+
+struct execute_action_t {
+    void
+    operator()() const;
+
+    std::atomic<size_t>& depth;
+
+    const std::shared_ptr<offload_stats_t> stats;
+    const std::function<void()> task;
+
+    // Time point when the task has been queued.
+    const clock_type::time_point queued;
+};
+
+void
+execute_action_t::operator()() const {
+    const auto started = clock_type::now();
+
+    try {
+        task();
+    } catch(...) {
+        // Slots are expected to report their errors via upstreams by themselves. Anything else is
+        // swallowed here, because there's no one to report it to and worker threads must survive.
+    }
+
+    const auto completed = clock_type::now();
+
+    stats->waiting += std::chrono::duration_cast<std::chrono::microseconds>(started - queued).count();
+    stats->running += std::chrono::duration_cast<std::chrono::microseconds>(completed - started).count();
+
+    stats->processed++;
+    stats->queued--;
+
+    depth--;
+}
+
+} // namespace
+
+offload_stats_t::offload_stats_t():
+    queued(0),
+    processed(0),
+    rejected(0),
+    waiting(0),
+    running(0)
+{ }
+
+offload_pool_t::offload_pool_t(size_t threads, size_t limit):
+    m_limit(limit),
+    m_depth(0),
+    m_work(new asio::io_service::work(m_asio))
+{
+    if(threads == 0 || limit == 0) {
+        throw cocaine::error_t("offload pool size and queue limit must be positive");
+    }
+
+    for(size_t i = 0; i < threads; ++i) {
+        m_threads.create_thread(run_action_t{m_asio});
+    }
+}
+
+offload_pool_t::~offload_pool_t() {
+    // Let the worker threads exit as soon as they have drained the queue.
+    m_work.reset();
+    m_threads.join_all();
+}
+
+size_t
+offload_pool_t::depth() const {
+    return m_depth;
+}
+
+dynamic_t
+offload_pool_t::stats() const {
+    dynamic_t::object_t result;
+
+    const auto ptr = m_stats.synchronize();
+
+    for(auto it = ptr->begin(); it != ptr->end(); ++it) {
+        const uint64_t processed = it->second->processed;
+
+        dynamic_t::object_t slot;
+
+        slot["queued"   ] = dynamic_t::uint_t(it->second->queued);
+        slot["processed"] = dynamic_t::uint_t(processed);
+        slot["rejected" ] = dynamic_t::uint_t(it->second->rejected);
+
+        // Average latencies in microseconds.
+        slot["waiting"] = dynamic_t::uint_t(processed ? it->second->waiting / processed : 0);
+        slot["running"] = dynamic_t::uint_t(processed ? it->second->running / processed : 0);
+
+        result[it->first] = slot;
+    }
+
+    dynamic_t::object_t info;
+
+    info["depth"] = dynamic_t::uint_t(m_depth);
+    info["limit"] = dynamic_t::uint_t(m_limit);
+    info["slots"] = result;
+
+    return info;
+}
+
+std::shared_ptr<offload_stats_t>
+offload_pool_t::attach(const std::string& slot) {
+    auto ptr = m_stats.synchronize();
+
+    if(!ptr->count(slot)) {
+        ptr->insert({slot, std::make_shared<offload_stats_t>()});
+    }
+
+    return ptr->at(slot);
+}
+
+bool
+offload_pool_t::post(const std::shared_ptr<offload_stats_t>& stats, std::function<void()> task) {
+    if(m_depth++ >= m_limit) {
+        m_depth--;
+        stats->rejected++;
+        return false;
+    }
+
+    stats->queued++;
+
+    m_asio.post(execute_action_t{m_depth, stats, std::move(task), clock_type::now()});
+
+    return true;
+}
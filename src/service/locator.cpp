@@ -27,6 +27,7 @@
 #include "cocaine/context.hpp"
 
 #include "cocaine/detail/actor.hpp"
+#include "cocaine/detail/engine.hpp"
 #include "cocaine/detail/unique_id.hpp"
 #include "cocaine/detail/waitable.hpp"
 
@@ -34,6 +35,7 @@
 
 #include "cocaine/logging.hpp"
 
+#include "cocaine/traits/dynamic.hpp"
 #include "cocaine/traits/endpoint.hpp"
 #include "cocaine/traits/graph.hpp"
 #include "cocaine/traits/map.hpp"
@@ -245,6 +247,8 @@ locator_t::locator_t(context_t& context, io_service& asio, const std::string& na
     on<locator::connect>(std::bind(&locator_t::on_connect, this, _1));
     on<locator::refresh>(std::bind(&locator_t::on_refresh, this, _1));
     on<locator::cluster>(std::bind(&locator_t::on_cluster, this));
+    on<locator::metrics>(std::bind(&locator_t::on_metrics, this));
+    on<locator::runtime>(std::bind(&locator_t::on_runtime, this));
 
     // Service restrictions
 
@@ -498,6 +502,87 @@ locator_t::on_cluster() const -> results::cluster {
     return result;
 }
 
+auto
+locator_t::on_metrics() -> results::metrics {
+    std::vector<std::string> names;
+
+    {
+        std::lock_guard<std::mutex> guard(m_mutex);
+
+        for(auto it = m_snapshot.begin(); it != m_snapshot.end(); ++it) {
+            names.push_back(it->first);
+        }
+    }
+
+    dynamic_t::object_t result;
+
+    for(auto it = names.begin(); it != names.end(); ++it) {
+        if(auto actor = m_context.locate(*it)) {
+            result[*it] = actor->prototype().metrics();
+        }
+    }
+
+    return result;
+}
+
+namespace {
+
+// Gathers the runtime information from all the execution units, each of them reporting on its own
+// reactor thread, and completes the request when the last one has reported.
+
+class inspect_action_t {
+    deferred<results::runtime> promise;
+
+    synchronized<dynamic_t::array_t> units;
+    std::atomic<size_t> pending;
+
+public:
+    inspect_action_t(const deferred<results::runtime>& promise_, size_t count):
+        promise(promise_),
+        units(dynamic_t::array_t(count)),
+        pending(count)
+    { }
+
+    void
+    operator()(size_t index, const dynamic_t& info);
+};
+
+void
+inspect_action_t::operator()(size_t index, const dynamic_t& info) {
+    units.synchronize()->at(index) = info;
+
+    if(--pending) {
+        return;
+    }
+
+    dynamic_t::object_t result;
+
+    result["units"] = *units.synchronize();
+
+    promise.write(dynamic_t(result));
+}
+
+} // namespace
+
+auto
+locator_t::on_runtime() const -> deferred<results::runtime> {
+    deferred<results::runtime> promise;
+
+    const auto& pool = m_context.pool();
+
+    if(pool.empty()) {
+        return promise.write(dynamic_t(dynamic_t::object_t()));
+    }
+
+    const auto action = std::make_shared<inspect_action_t>(promise, pool.size());
+
+    for(size_t i = 0; i < pool.size(); ++i) {
+        pool[i]->inspect(std::bind(&inspect_action_t::operator(), action, i, std::placeholders::_1));
+    }
+
+    return promise;
+}
+
 void
 locator_t::on_service(const actor_t& actor) {
     if(m_cfg.restricted.count(actor.prototype().name())) {
@@ -510,12 +595,15 @@ locator_t::on_service(const actor_t& actor) {
         actor.prototype().graph()
     };
 
-    const auto response = results::connect {
+    typedef streamed<results::connect>::protocol::chunk chunk_type;
+
+    // The update is the same for all the remote nodes, so it's encoded only once.
+    const auto response = io::make_preencoded<chunk_type>(results::connect {
         m_cfg.uuid, {{
             actor.prototype().name(),
             metadata
         }}
-    };
+    });
 
     std::lock_guard<std::mutex> guard(m_mutex);
 
@@ -81,8 +81,8 @@ public:
 
 private:
     void
-    write(const std::string& chunk) {
-        downstream->write(chunk.data(), chunk.size());
+    write(const io::slice_t& chunk) {
+        downstream->write(chunk.blob, chunk.size, chunk.owner());
     }
 
     void
@@ -139,7 +139,13 @@ private:
         virtual
         void
         write(const char* chunk, size_t size) {
-            upstream.send<protocol::chunk>(literal_t { chunk, size });
+            upstream = upstream.send<protocol::chunk>(literal_t { chunk, size });
+        }
+
+        virtual
+        void
+        write(const char* chunk, size_t size, const std::shared_ptr<const void>& owner) {
+            upstream = upstream.send<protocol::chunk>(literal_t { chunk, size, owner });
         }
 
         virtual
@@ -154,6 +160,18 @@ private:
             upstream.send<protocol::choke>();
         }
 
+        virtual
+        bool
+        would_block() const {
+            return upstream.would_block();
+        }
+
+        virtual
+        void
+        await(const std::function<void()>& handler) {
+            upstream.await(handler);
+        }
+
     private:
         enqueue_slot_t::upstream_type upstream;
     };
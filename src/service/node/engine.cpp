@@ -67,6 +67,18 @@ struct ignore {
 
 namespace {
 
+// Arrivals are sampled once a second, and each sample contributes a fifth of itself to the rate, so
+// the rate follows the load within a few seconds but isn't thrown off by a single spike.
+const long kSampleInterval = 1000;
+
+const double kRateWeight    = 0.2;
+const double kStartupWeight = 0.2;
+const double kBusyWeight    = 0.2;
+
+// A slave is retired only if the remaining slaves would be loaded to no more than this fraction of
+// their capacity, so that the pool doesn't have to grow right back.
+const double kShrinkThreshold = 0.5;
+
 const char* describe[] = {
     "running",
     "broken",
@@ -74,6 +86,19 @@ const char* describe[] = {
     "stopped"
 };
 
+// Retirement candidates, the least warmed up first: the one which has served the fewest sessions,
+// and the youngest of those.
+struct warmed {
+    bool
+    operator()(const std::shared_ptr<slave_t>& lhs, const std::shared_ptr<slave_t>& rhs) const {
+        if(lhs->served() != rhs->served()) {
+            return lhs->served() < rhs->served();
+        }
+
+        return lhs->uptime() < rhs->uptime();
+    }
+};
+
 struct collector_t {
     template<class>
     struct result {
@@ -112,51 +137,6 @@ private:
 
 } // namespace
 
-namespace {
-
-struct load {
-    template<class T>
-    bool
-    operator()(const T& lhs, const T& rhs) const {
-        return lhs.second->load() < rhs.second->load();
-    }
-};
-
-struct available {
-    template<class T>
-    bool
-    operator()(const T& slave) const {
-        return slave.second->active() && slave.second->load() < max;
-    }
-
-    const size_t max;
-};
-
-template<class It, class Compare, class Predicate>
-inline
-It
-min_element_if(It first, It last, Compare compare, Predicate predicate) {
-    while(first != last && !predicate(*first)) {
-        ++first;
-    }
-
-    if(first == last) {
-        return last;
-    }
-
-    It result = first;
-
-    while(++first != last) {
-        if(predicate(*first) && compare(*first, *result)) {
-            result = first;
-        }
-    }
-
-    return result;
-}
-
-} // namespace
-
 engine_t::engine_t(context_t& context, const manifest_t& manifest, const profile_t& profile):
     m_context(context),
     m_log(context.log(manifest.name)),
@@ -166,7 +146,14 @@ engine_t::engine_t(context_t& context, const manifest_t& manifest, const profile
     m_termination_timer(m_loop),
     m_socket(m_loop),
     m_acceptor(m_loop, protocol_type::endpoint(m_manifest.endpoint)),
-    m_next_id(1)
+    m_next_id(1),
+    m_queue_depth(0),
+    m_arrivals(0),
+    m_sampled(0),
+    m_sample_timer(m_loop),
+    m_rate(kRateWeight),
+    m_startup(kStartupWeight),
+    m_busy(kBusyWeight)
 {
     m_isolate = m_context.get<api::isolate_t>(
         m_profile.isolate.type,
@@ -200,6 +187,9 @@ engine_t::run() {
         std::bind(&engine_t::on_accept, this, ph::_1)
     );
 
+    m_sample_timer.expires_from_now(boost::posix_time::milliseconds(kSampleInterval));
+    m_sample_timer.async_wait(std::bind(&engine_t::on_sample, this, ph::_1));
+
     m_state = states::running;
     std::error_code ec;
     m_loop.run(ec);
@@ -217,14 +207,16 @@ engine_t::enqueue(const api::event_t& event, const std::shared_ptr<api::stream_t
         throw cocaine::error_t("the engine is not active");
     }
 
-    auto session = std::make_shared<session_t>(m_next_id++, event, upstream);
-
-    std::lock_guard<session_queue_t> lock(m_queue);
-    if(m_profile.queue_limit > 0 && m_queue.size() >= m_profile.queue_limit) {
+    // Reserve a place in the queue first, so that concurrent clients can't overflow it.
+    if(m_queue_depth++ >= m_profile.queue_limit && m_profile.queue_limit > 0) {
+        m_queue_depth--;
         throw cocaine::error_t("the queue is full");
     }
 
-    m_queue.push(session);
+    auto session = std::make_shared<session_t>(m_next_id++, event, upstream);
+
+    m_arrivals++;
+    m_inbox.push(session);
     wake();
     return std::make_shared<session_t::downstream_t>(session);
 }
@@ -257,12 +249,14 @@ engine_t::enqueue(const api::event_t& event, const std::shared_ptr<api::stream_t
                         m_manifest,
                         m_profile,
                         m_context,
-                        std::bind(&engine_t::wake, this),
+                        std::bind(&engine_t::update, this, ph::_1),
                         std::bind(&engine_t::erase, this, ph::_1, ph::_2, ph::_3),
                         m_loop
                     )
                 )
             );
+
+            m_tagged.insert(tag);
         }
     }
 
@@ -276,7 +270,15 @@ engine_t::erase(const std::string& id, int code, const std::string& reason) {
     COCAINE_LOG_DEBUG(m_log, "erasing slave '%s' from the pool", id);
 
     std::lock_guard<std::mutex> lock(m_pool_mutex);
-    m_pool.erase(id);
+
+    const auto it = m_pool.find(id);
+
+    if(it != m_pool.end()) {
+        m_index.erase(it->second);
+        m_pool.erase(it);
+    }
+
+    m_tagged.erase(id);
 
     if(code == rpc::terminate::abnormal) {
         COCAINE_LOG_ERROR(m_log, "the app seems to be broken: %s", reason);
@@ -291,7 +293,24 @@ engine_t::erase(const std::string& id, int code, const std::string& reason) {
     }
 }
 
-void engine_t::wake() {
+void
+engine_t::update(const std::shared_ptr<slave_t>& slave) {
+    BOOST_ASSERT(std::this_thread::get_id() == m_thread.get_id());
+
+    if(!m_index.count(slave) && slave->active()) {
+        // The slave has just become active.
+        m_startup.add(slave->startup());
+    }
+
+    const size_t load = slave->load();
+
+    m_index.update(slave, load, slave->active() && load < m_profile.concurrency);
+
+    wake();
+}
+
+void
+engine_t::wake() {
     m_loop.post(std::bind(&engine_t::do_wake, this));
 }
 
@@ -308,6 +327,8 @@ engine_t::do_info(std::function<void(dynamic_t::object_t)> callback) {
 
     collector_t collector;
 
+    drain();
+
     std::lock_guard<std::mutex> plock(m_pool_mutex);
 
     size_t active = std::count_if(
@@ -316,18 +337,19 @@ engine_t::do_info(std::function<void(dynamic_t::object_t)> callback) {
         std::bind<bool>(std::ref(collector), ph::_1)
     );
 
-    std::lock_guard<session_queue_t> qlock(m_queue);
     dynamic_t::object_t info;
     info["profile"] = m_profile.name;
     info["load-median"] = dynamic_t::uint_t(collector.median());
     info["queue"] = dynamic_t::object_t(
         {
             { "capacity", dynamic_t::uint_t(m_profile.queue_limit) },
-            { "depth",    dynamic_t::uint_t(m_queue.size()) }
+            { "depth",    dynamic_t::uint_t(m_queue.size()) },
+            { "rate",     dynamic_t::double_t(m_rate.get()) }
         }
     );
     info["sessions"] = dynamic_t::object_t(
         {
+            { "average", dynamic_t::double_t(m_busy.get()) },
             { "pending", dynamic_t::uint_t(collector.sum()) }
         }
     );
@@ -335,7 +357,10 @@ engine_t::do_info(std::function<void(dynamic_t::object_t)> callback) {
         {
             { "active",   dynamic_t::uint_t(active) },
             { "capacity", dynamic_t::uint_t(m_profile.pool_limit) },
-            { "idle",     dynamic_t::uint_t(m_pool.size() - active) }
+            { "idle",     dynamic_t::uint_t(m_pool.size() - active) },
+            { "minimum",  dynamic_t::uint_t(m_profile.pool_minimum) },
+            { "startup",  dynamic_t::double_t(m_startup.get()) },
+            { "warm",     dynamic_t::uint_t(m_profile.warm_pool) }
         }
     );
     info["state"] = std::string(describe[static_cast<int>(m_state)]);
@@ -444,42 +469,74 @@ engine_t::on_termination(const std::error_code& ec) {
         return;
     }
 
-    std::lock_guard<session_queue_t> queue_guard(m_queue);
     COCAINE_LOG_WARNING(m_log, "forcing the engine termination due to timeout");
     stop();
 }
 
+void
+engine_t::on_sample(const std::error_code& ec) {
+    if(ec == asio::error::operation_aborted) {
+        return;
+    }
+
+    const uint64_t arrivals = m_arrivals;
+
+    m_rate.add((arrivals - m_sampled) * 1000.0 / kSampleInterval);
+    m_sampled = arrivals;
+
+    m_busy.add(m_index.total());
+
+    // The pool is grown by the predicted demand even without any traffic waking the engine up. The
+    // warm slaves are replenished only here, so that a slave failing to spawn can't make the engine
+    // respawn it in a tight loop. Likewise, the pool is shrunk at most by one slave per sample.
+    balance();
+    warm();
+    shrink();
+
+    m_sample_timer.expires_from_now(boost::posix_time::milliseconds(kSampleInterval));
+    m_sample_timer.async_wait(std::bind(&engine_t::on_sample, this, ph::_1));
+}
+
+void
+engine_t::drain() {
+    session_queue_t::value_type session;
+
+    while(m_inbox.pop(session)) {
+        m_queue.push(session);
+    }
+}
+
 void
 engine_t::pump() {
     session_queue_t::value_type session;
 
-    while(!m_queue.empty()) {
-        std::lock_guard<std::mutex> pool_guard(m_pool_mutex);
+    drain();
 
-        const auto it = min_element_if(m_pool.begin(), m_pool.end(), load(), available {
-            m_profile.concurrency
-        });
+    std::shared_ptr<slave_t> slave;
 
-        if(it == m_pool.end()) {
-            return;
+    // Every dispatch is O(log P), so the whole queue is assigned in one pass without locking the
+    // pool, as both the index and the slaves are only touched on the engine thread.
+    while(!m_queue.empty() && m_index.top(slave)) {
+        if(!slave->active() || slave->load() >= m_profile.concurrency) {
+            // The slave has gone busy or inactive without notifying the engine yet, so fix up its
+            // rank and pick another one.
+            m_index.update(slave, slave->load(), false);
+            continue;
         }
 
-        {
-            std::lock_guard<session_queue_t> lock(m_queue);
-            if(m_queue.empty()) {
-                return;
-            }
+        // Move out a new session from the queue.
+        session = std::move(m_queue.front());
 
-            // Move out a new session from the queue.
-            session = std::move(m_queue.front());
+        // Destroy an empty session husk.
+        m_queue.pop_front();
+        m_queue_depth--;
 
-            // Destroy an empty session husk.
-            m_queue.pop_front();
-        }
+        // Assigning from the engine thread is synchronous, so the slave load is exact afterwards.
+        slave->assign(session);
+
+        const size_t load = slave->load();
 
-        // Process the queue head outside the lock, because it might take some considerable amount
-        // of time if the session has expired and there's some heavy-lifting in the error handler.
-        it->second->assign(session);
+        m_index.update(slave, load, slave->active() && load < m_profile.concurrency);
     }
 }
 
@@ -487,25 +544,111 @@ void
 engine_t::balance() {
     std::lock_guard<std::mutex> pool_guard(m_pool_mutex);
 
-    if(m_pool.size() >= m_profile.pool_limit ||
-       m_pool.size() * m_profile.grow_threshold >= m_queue.size())
-    {
+    if(m_state != states::running) {
+        return;
+    }
+
+    double expected = m_queue.size();
+
+    // NOTE: By Little's law, a steady arrival rate is served by the sessions in progress, not queued,
+    // as long as the pool keeps up with it, i.e. the queue is empty. Once it doesn't, the sessions
+    // which will arrive while the new slaves are starting up are going to be queued as well, so they
+    // are accounted in advance. Otherwise, the pool would be grown by the rate even when idle, only
+    // to be shrunk right back.
+    if(!m_queue.empty()) {
+        expected += m_rate.get() * m_startup.get();
+    }
+
+    if(expected < 1.0 || m_pool.size() * m_profile.grow_threshold >= expected) {
+        return;
+    }
+
+    spawn(std::max(1UL, static_cast<unsigned long>(expected / m_profile.grow_threshold)));
+}
+
+void
+engine_t::warm() {
+    std::lock_guard<std::mutex> pool_guard(m_pool_mutex);
+
+    if(m_state != states::running) {
+        return;
+    }
+
+    // Slaves which are still starting up are not indexed yet, but they're going to be idle as well.
+    const size_t idle = m_pool.size() - m_index.size() + m_index.idle();
+
+    size_t target = m_profile.pool_minimum;
+
+    if(idle < m_profile.warm_pool) {
+        target = std::max(target, m_pool.size() + m_profile.warm_pool - idle);
+    }
+
+    spawn(target);
+}
+
+void
+engine_t::shrink() {
+    std::lock_guard<std::mutex> pool_guard(m_pool_mutex);
+
+    // NOTE: Zero idle timeout means that the slaves are never retired, as before.
+    if(m_state != states::running || !m_profile.idle_timeout) {
+        return;
+    }
+
+    // Wait for the previously retired slave to leave the pool.
+    if(!m_retiring.empty() && m_pool.count(m_retiring)) {
         return;
     }
 
-    const unsigned int target = std::min(
-        m_profile.pool_limit,
-        std::max(
-            1UL,
-            m_queue.size() / m_profile.grow_threshold
-        )
+    if(m_pool.size() <= m_profile.pool_minimum || m_index.idle() <= m_profile.warm_pool) {
+        return;
+    }
+
+    const double remaining = (m_index.size() - 1) * m_profile.concurrency * kShrinkThreshold;
+
+    if(m_busy.get() >= std::max(remaining, 1.0)) {
+        return;
+    }
+
+    auto victim = m_pool.end();
+
+    for(auto it = m_pool.begin(); it != m_pool.end(); ++it) {
+        if(m_tagged.count(it->first) || it->second->idle() < m_profile.idle_timeout) {
+            continue;
+        }
+
+        if(victim == m_pool.end() || warmed()(it->second, victim->second)) {
+            victim = it;
+        }
+    }
+
+    if(victim == m_pool.end()) {
+        return;
+    }
+
+    COCAINE_LOG_INFO(m_log, "retiring slave '%s' from the pool of %d", victim->first, m_pool.size())(
+        "busy", m_busy.get(),
+        "served", victim->second->served()
     );
 
+    m_retiring = victim->first;
+
+    victim->second->retire();
+    m_index.update(victim->second, 0, false);
+}
+
+void
+engine_t::spawn(size_t target) {
+    target = std::min(target, static_cast<size_t>(m_profile.pool_limit));
+
     if(target <= m_pool.size()) {
         return;
     }
 
-    COCAINE_LOG_INFO(m_log, "enlarging the slaves pool from %d to %d", m_pool.size(), target);
+    COCAINE_LOG_INFO(m_log, "enlarging the slaves pool from %d to %d", m_pool.size(), target)(
+        "queue", m_queue.size(),
+        "rate", m_rate.get()
+    );
 
     while(m_pool.size() != target) {
         const auto id = unique_id_t().string();
@@ -514,7 +657,7 @@ engine_t::balance() {
             m_manifest,
             m_profile,
             m_context,
-            std::bind(&engine_t::wake, this),
+            std::bind(&engine_t::update, this, ph::_1),
             std::bind(&engine_t::erase, this, ph::_1, ph::_2, ph::_3),
             m_loop
         );
@@ -523,10 +666,10 @@ engine_t::balance() {
 
 void
 engine_t::migrate(states target) {
-    std::lock_guard<session_queue_t> lock(m_queue);
-
     m_state = target;
 
+    drain();
+
     if(!m_queue.empty()) {
         COCAINE_LOG_DEBUG(
             m_log,
@@ -542,6 +685,7 @@ engine_t::migrate(states target) {
             );
 
             m_queue.pop_front();
+            m_queue_depth--;
         }
     }
 
@@ -576,9 +720,12 @@ engine_t::stop() {
     COCAINE_LOG_DEBUG(m_log, "stopping '%s' engine", m_manifest.name);
     m_acceptor.cancel();
     m_termination_timer.cancel();
+    m_sample_timer.cancel();
 
     // NOTE: This will force the slave pool termination.
+    m_index.clear();
     m_pool.clear();
+    m_tagged.clear();
 
     if(m_state == states::stopping) {
         m_state = states::stopped;
@@ -39,6 +39,8 @@ profile_t::profile_t(context_t& context, const std::string& name_):
     crashlog_limit      = as_object().at("crashlog-limit", defaults::crashlog_limit).to<uint64_t>();
     pool_limit          = as_object().at("pool-limit", defaults::pool_limit).to<uint64_t>();
     queue_limit         = as_object().at("queue-limit", defaults::queue_limit).to<uint64_t>();
+    warm_pool           = as_object().at("warm-pool", defaults::warm_pool).to<uint64_t>();
+    pool_minimum        = as_object().at("pool-minimum", defaults::pool_minimum).to<uint64_t>();
 
     unsigned long default_threshold = std::max(1UL, queue_limit / pool_limit / 2);
 
@@ -78,5 +80,13 @@ profile_t::profile_t(context_t& context, const std::string& name_):
     if(concurrency == 0) {
         throw cocaine::error_t("engine concurrency must be positive");
     }
+
+    if(warm_pool > pool_limit) {
+        throw cocaine::error_t("engine warm pool must not exceed the pool limit");
+    }
+
+    if(pool_minimum > pool_limit) {
+        throw cocaine::error_t("engine pool minimum must not exceed the pool limit");
+    }
 }
 
@@ -33,7 +33,7 @@ using namespace cocaine::io;
 class session_t::push_action_t:
     public std::enable_shared_from_this<push_action_t>
 {
-    const encoder_t::message_type message;
+    encoder_t::message_type message;
 
     // Keeps the session alive until all the operations are complete.
     const std::shared_ptr<session_t> session;
@@ -47,7 +47,7 @@ public:
     void
     operator()(const std::shared_ptr<writable_stream<protocol_type, encoder_t>>& stream) {
         stream->write(
-            message,
+            std::move(message),
             std::bind(&push_action_t::on_write, shared_from_this(), ph::_1)
         );
     }
@@ -90,6 +90,18 @@ public:
         );
         (*push)(m_downstream);
     }
+
+    template<class Event, typename... Args>
+    void
+    append(encoder_t::message_type& batch, Args&&... args) {
+        batch.append<Event>(m_session->id, std::forward<Args>(args)...);
+    }
+
+    void
+    push(encoder_t::message_type&& batch) {
+        auto push = std::make_shared<push_action_t>(std::move(batch), m_session);
+        (*push)(m_downstream);
+    }
 };
 
 session_t::session_t(uint64_t id_, const api::event_t& event_, const api::stream_ptr_t& upstream_):
@@ -137,7 +149,14 @@ session_t::downstream_t::~downstream_t() {
 
 void
 session_t::downstream_t::write(const char* chunk, size_t size) {
-    parent->send<rpc::chunk>(std::string(chunk, size));
+    parent->send<rpc::chunk>(literal_t { chunk, size });
+}
+
+void
+session_t::downstream_t::write(const char* chunk, size_t size, const std::shared_ptr<const void>& owner) {
+    // Chunks are attached to the outgoing messages by reference. They are only copied if the session
+    // is still waiting for a slave, because frozen messages must own their arguments.
+    parent->send<rpc::chunk>(literal_t { chunk, size, owner });
 }
 
 void
@@ -88,13 +88,10 @@ slave_t::slave_t(const std::string& id,
     m_rebalance(rebalance),
     m_suicide(suicide),
     m_state(states::unknown),
-#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
-    m_birthstamp(std::chrono::steady_clock::now()),
-#else
-    m_birthstamp(std::chrono::monotonic_clock::now()),
-#endif
-    m_heartbeat_timer(asio),
-    m_idle_timer(asio)
+    m_birthstamp(clock_type::now()),
+    m_startup(0),
+    m_served(0),
+    m_heartbeat_timer(asio)
 {
     asio.post(std::bind(&slave_t::activate, this));
 }
@@ -111,12 +108,13 @@ slave_t::bind(const std::shared_ptr<io::channel<protocol_type>>& channel) {
     BOOST_ASSERT(!m_channel);
 
     m_channel = channel;
-    m_channel->reader->read(m_message, std::bind(&slave_t::on_read, shared_from_this(), ph::_1));
+
+    pull();
 }
 
 void
 slave_t::assign(const std::shared_ptr<session_t>& session) {
-    m_asio.post(std::bind(&slave_t::do_assign, shared_from_this(), session));
+    m_asio.dispatch(std::bind(&slave_t::do_assign, shared_from_this(), session));
 }
 
 void
@@ -144,7 +142,6 @@ slave_t::do_assign(std::shared_ptr<session_t> session) {
         session->upstream->error(error::deadline_error, "the session has expired in the queue");
         return;
     }
-    m_idle_timer.cancel();
 
     if(m_sessions.size() >= m_profile.concurrency || m_state == states::unknown) {
         m_queue.push_back(session);
@@ -153,6 +150,7 @@ slave_t::do_assign(std::shared_ptr<session_t> session) {
 
     BOOST_ASSERT(m_state == states::active);
     m_sessions.insert(std::make_pair(session->id, session));
+    m_served++;
 
     COCAINE_LOG_DEBUG(m_log, "slave %s has started processing %d session", m_id, session->id);
     session->attach(m_channel->writer);
@@ -207,6 +205,16 @@ slave_t::activate() {
     }
 }
 
+void
+slave_t::pull() {
+    if(!m_channel) {
+        // The slave has been terminated while it was throttled.
+        return;
+    }
+
+    m_channel->reader->read(m_message, std::bind(&slave_t::on_read, shared_from_this(), ph::_1));
+}
+
 void
 slave_t::on_read(const std::error_code& ec) {
     if(ec) {
@@ -216,10 +224,28 @@ slave_t::on_read(const std::error_code& ec) {
         on_failure(ec);
     } else {
         on_message(m_message);
-        m_channel->reader->read(m_message, std::bind(&slave_t::on_read, shared_from_this(), ph::_1));
+
+        if(const auto stream = std::move(m_throttled)) {
+            // The client doesn't keep up with the chunks, so stop reading from the worker until it
+            // catches up, instead of buffering the whole response in the client's session.
+            // NOTE: This holds off all the other sessions of this worker as well, just like a full
+            // socket buffer would.
+            try {
+                return stream->await(std::bind(&slave_t::on_resume, shared_from_this()));
+            } catch(const cocaine::error_t&) {
+                // The client has disconnected, so there's nothing to wait for.
+            }
+        }
+
+        pull();
     }
 }
 
+void
+slave_t::on_resume() {
+    m_asio.post(std::bind(&slave_t::pull, shared_from_this()));
+}
+
 void
 slave_t::on_write(const std::error_code& ec) {
     if(ec) {
@@ -280,10 +306,14 @@ slave_t::on_message(const io::decoder_t::message_type& message) {
         break;
     }
     case event_traits<rpc::chunk>::id: {
-        std::string chunk;
+        // The chunk is viewed right in the receive buffer and spliced into the outgoing messages by
+        // reference, so neither the worker side nor the client side copies its bytes, unless it's
+        // too small to pin the whole receive buffer for, see decoded_message_t::pin().
+        io::slice_t chunk;
         io::type_traits<
-            typename io::event_traits<rpc::chunk>::argument_type
+            boost::mpl::list<io::view<std::string>>
         >::unpack(message.args(), chunk);
+        message.pin(chunk);
         on_chunk(message.span(), chunk);
         break;
     }
@@ -339,24 +369,17 @@ slave_t::on_ping() {
     );
 
     if(m_state == states::unknown) {
-#ifdef COCAINE_HAS_FEATURE_STEADY_CLOCK
-        auto now = std::chrono::steady_clock::now();
-#else
-        auto now = std::chrono::monotonic_clock::now();
-#endif
+        const auto now = clock_type::now();
         const auto uptime = std::chrono::duration_cast<
             std::chrono::duration<float>
         >(now - m_birthstamp);
 
         COCAINE_LOG_DEBUG(m_log, "slave %s became active in %.03f seconds", m_id, uptime.count());
 
-        m_state = states::active;
+        m_startup = uptime.count();
 
-        if(m_profile.idle_timeout) {
-            // Start the idle timer, which will kill the slave when it's not used.
-            m_idle_timer.expires_from_now(boost::posix_time::seconds(m_profile.idle_timeout));
-            m_idle_timer.async_wait(std::bind(&slave_t::on_idle, shared_from_this(), ph::_1));
-        }
+        m_state = states::active;
+        m_idlestamp = now;
 
         pump();
     }
@@ -372,11 +395,11 @@ slave_t::on_death(int code, const std::string& reason) {
 }
 
 void
-slave_t::on_chunk(uint64_t session_id, const std::string& chunk) {
+slave_t::on_chunk(uint64_t session_id, const io::slice_t& chunk) {
     BOOST_ASSERT(m_state == states::active);
 
     COCAINE_LOG_DEBUG(m_log, "slave %s received chunk in session %d", m_id, session_id)(
-        "size", chunk.size()
+        "size", chunk.size
     );
 
     auto it = m_sessions.find(session_id);
@@ -386,7 +409,11 @@ slave_t::on_chunk(uint64_t session_id, const std::string& chunk) {
     }
 
     try {
-        it->second->upstream->write(chunk.data(), chunk.size());
+        it->second->upstream->write(chunk.blob, chunk.size, chunk.owner());
+
+        if(it->second->upstream->would_block()) {
+            m_throttled = it->second->upstream;
+        }
     } catch (const cocaine::error_t& err) {
         COCAINE_LOG_WARNING(m_log, "slave %s is unable to send write event to the upstream: %s", m_id, err.what());
     }
@@ -465,12 +492,26 @@ slave_t::on_timeout(const std::error_code& ec) {
     terminate(rpc::terminate::code::normal, "slave has timed out");
 }
 
-void
-slave_t::on_idle(const std::error_code& ec) {
-    if(ec == asio::error::operation_aborted) {
-        return;
+float
+slave_t::uptime() const {
+    return std::chrono::duration_cast<std::chrono::duration<float>>(
+        clock_type::now() - m_birthstamp
+    ).count();
+}
+
+float
+slave_t::idle() const {
+    if(m_state != states::active || !m_sessions.empty() || !m_queue.empty()) {
+        return 0;
     }
 
+    return std::chrono::duration_cast<std::chrono::duration<float>>(
+        clock_type::now() - m_idlestamp
+    ).count();
+}
+
+void
+slave_t::retire() {
     BOOST_ASSERT(m_state == states::active);
     BOOST_ASSERT(m_sessions.empty() && m_queue.empty());
 
@@ -501,12 +542,12 @@ slave_t::pump() {
         assign(session);
     }
 
-    if(m_sessions.empty() && m_profile.idle_timeout) {
-        m_idle_timer.expires_from_now(boost::posix_time::seconds(m_profile.idle_timeout));
-        m_idle_timer.async_wait(std::bind(&slave_t::on_idle, shared_from_this(), ph::_1));
+    if(m_sessions.empty() && m_queue.empty()) {
+        // The engine decides whether to retire the slave based on how long it's been idle.
+        m_idlestamp = clock_type::now();
     }
 
-    m_rebalance();
+    m_rebalance(shared_from_this());
 }
 
 void
@@ -559,7 +600,6 @@ slave_t::terminate(int code, const std::string& reason) {
     }
 
     m_heartbeat_timer.cancel();
-    m_idle_timer.cancel();
 
     // Closes our end of the socket.
     m_channel.reset();
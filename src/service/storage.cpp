@@ -24,24 +24,59 @@
 
 #include "cocaine/dynamic/dynamic.hpp"
 
+#include "cocaine/rpc/slot/offloaded.hpp"
+
 using namespace cocaine::io;
 using namespace cocaine::service;
 
+namespace {
+
+void
+write_blob(const std::shared_ptr<api::storage_t>& storage, const std::string& collection,
+           const std::string& key, const slice_t& blob, const std::vector<std::string>& tags)
+{
+    storage->write(collection, key, blob.blob, blob.size, tags);
+}
+
+} // namespace
+
 storage_t::storage_t(context_t& context, asio::io_service& asio, const std::string& name, const dynamic_t& args):
     category_type(context, asio, name, args),
     dispatch<storage_tag>(name)
 {
     const auto storage = api::storage(context, args.as_object().at("backend", "core").as_string());
 
+    // Storage backends do synchronous I/O, so it's done on a separate pool to not stall the reactor.
+    // A single worker thread (default) preserves the request order.
+    const auto offload = args.as_object().at("offload", dynamic_t::empty_object).as_object();
+
+    m_pool = std::make_shared<offload_pool_t>(
+        offload.at("threads", 1U).as_uint(),
+        offload.at("limit", 1024U).as_uint()
+    );
+
     using namespace std::placeholders;
 
-    on<storage::read>(std::bind(&api::storage_t::read, storage, _1, _2));
-    on<storage::write>(std::bind(&api::storage_t::write, storage, _1, _2, _3, _4));
-    on<storage::remove>(std::bind(&api::storage_t::remove, storage, _1, _2));
-    on<storage::find>(std::bind(&api::storage_t::find, storage, _1, _2));
+    on<storage::read>(std::make_shared<offloaded_slot<storage::read>>(m_pool,
+        std::bind(&api::storage_t::read, storage, _1, _2)));
+    on<storage::write>(std::make_shared<offloaded_slot<storage::write>>(m_pool,
+        std::bind(&write_blob, storage, _1, _2, _3, _4)));
+    on<storage::remove>(std::make_shared<offloaded_slot<storage::remove>>(m_pool,
+        std::bind(&api::storage_t::remove, storage, _1, _2)));
+    on<storage::find>(std::make_shared<offloaded_slot<storage::find>>(m_pool,
+        std::bind(&api::storage_t::find, storage, _1, _2)));
 }
 
 auto
 storage_t::prototype() const -> const basic_dispatch_t& {
     return *this;
 }
+
+auto
+storage_t::metrics() const -> dynamic_t {
+    dynamic_t result = dispatch<storage_tag>::metrics();
+
+    result.as_object()["offload"] = m_pool->stats();
+
+    return result;
+}
@@ -33,18 +33,30 @@ using namespace cocaine::io;
 
 // Session internals
 
-class session_t::channel_t {
+class session_t::channel_t:
+    public std::enable_shared_from_this<channel_t>
+{
     friend class session_t;
 
     dispatch_ptr_t dispatch;
-    upstream_ptr_t upstream;
+
+    // The upstream is embedded into the channel, so that both of them are allocated at once.
+    // Upstream pointers share the ownership of the whole channel.
+    basic_upstream_t upstream;
 
 public:
-    channel_t(const dispatch_ptr_t& dispatch_, const upstream_ptr_t& upstream_):
+    channel_t(const dispatch_ptr_t& dispatch_, const std::shared_ptr<session_t>& session,
+              uint64_t channel_id)
+    :
         dispatch(dispatch_),
-        upstream(upstream_)
+        upstream(session, channel_id)
     { }
 
+    auto
+    ptr() -> upstream_ptr_t {
+        return upstream_ptr_t(shared_from_this(), &upstream);
+    }
+
     void
     process(const decoder_t::message_type& message);
 };
@@ -55,11 +67,14 @@ session_t::channel_t::process(const decoder_t::message_type& message) {
         throw cocaine::error_t("no dispatch has been assigned");
     }
 
-    if((dispatch = dispatch->process(message, upstream).get_value_or(dispatch)) == nullptr) {
+    // NOTE: The dispatch is copied here, because the channel might be revoked while the message is
+    // being processed, and revoked channels release their dispatches.
+    const auto current = dispatch;
+
+    if((dispatch = current->process(message, ptr()).get_value_or(current)) == nullptr) {
         // NOTE: If the client has sent us the last message according to our dispatch graph, then
         // revoke the channel.
-        upstream->drop();
-        upstream = nullptr;
+        upstream.drop();
     }
 }
 
@@ -111,6 +126,13 @@ session_t::pull_action_t::finalize(const std::error_code& ec) {
             return;
         }
 
+        if(session->blocked) {
+            // The client doesn't keep up with the responses, so stop reading its requests until the
+            // backlog is drained, instead of buffering more and more responses.
+            session->paused = shared_from_this();
+            return;
+        }
+
         operator()(std::move(ptr));
     }
 }
@@ -118,15 +140,16 @@ session_t::pull_action_t::finalize(const std::error_code& ec) {
 class session_t::push_action_t:
     public enable_shared_from_this<push_action_t>
 {
-    const encoder_t::message_type message;
-
     // Keeps the session alive until all the operations are complete.
     const std::shared_ptr<session_t> session;
 
+    // Total size of the batch.
+    size_t bytes;
+
 public:
-    push_action_t(encoder_t::message_type&& message, const std::shared_ptr<session_t>& session_):
-        message(std::move(message)),
-        session(session_)
+    push_action_t(const std::shared_ptr<session_t>& session_):
+        session(session_),
+        bytes(0)
     { }
 
     void
@@ -139,24 +162,52 @@ private:
 
 void
 session_t::push_action_t::operator()(std::shared_ptr<channel<tcp>> ptr) {
-    ptr->writer->write(message, std::bind(&push_action_t::finalize,
+    std::vector<encoder_t::message_type> batch(std::move(session->spare));
+
+    // Grab everything pushed so far. Any subsequent push will find the outbox empty and schedule
+    // another flush.
+    std::swap(batch, *session->outbox.synchronize());
+
+    if(batch.empty()) {
+        session->spare = std::move(batch);
+        return;
+    }
+
+    for(auto it = batch.begin(); it != batch.end(); ++it) {
+        bytes += it->size();
+    }
+
+    for(auto it = batch.begin(); it != batch.end() - 1; ++it) {
+        ptr->writer->write(std::move(*it), nullptr);
+    }
+
+    // NOTE: Write errors are reported to every pending message, so a single handler attached to the
+    // last message of the batch is enough to detect them.
+    ptr->writer->write(std::move(batch.back()), std::bind(&push_action_t::finalize,
         shared_from_this(),
         std::placeholders::_1
     ));
+
+    batch.clear();
+
+    // Keep the storage for the next flush.
+    session->spare = std::move(batch);
 }
 
 void
 session_t::push_action_t::finalize(const std::error_code& ec) {
     if(ec) {
         session->signals.shutdown(ec);
+    } else {
+        session->release(bytes);
     }
 }
 
 class session_t::discard_action_t {
-    synchronized<channel_map_t>& channels;
+    channel_map_t& channels;
 
 public:
-    discard_action_t(synchronized<channel_map_t>& channels_):
+    discard_action_t(channel_map_t& channels_):
         channels(channels_)
     { }
 
@@ -166,22 +217,51 @@ public:
 
 void
 session_t::discard_action_t::operator()(const std::error_code& ec) {
-    auto ptr = channels.synchronize();
-
-    for(auto it = ptr->begin(); it != ptr->end(); ++it) {
+    // NOTE: Shutdown signals are always fired on the session's reactor thread.
+    for(auto it = channels.begin(); it != channels.end(); ++it) {
         if(it->second->dispatch) it->second->dispatch->discard(ec);
+
+        // Upstreams might still be in use, keeping their channels alive, so release the dispatches
+        // right away instead.
+        it->second->dispatch = nullptr;
     }
 
-    ptr->clear();
+    channels.clear();
 }
 
+class session_t::snapshot_action_t {
+    // Keeps the session alive until the reactor gets to the action.
+    const std::shared_ptr<const session_t> session;
+
+    const std::function<void(const channel_names_t&)> handler;
+
+public:
+    snapshot_action_t(const std::shared_ptr<const session_t>& session_,
+                      const std::function<void(const channel_names_t&)>& handler_)
+    :
+        session(session_),
+        handler(handler_)
+    { }
+
+    void
+    operator()() const {
+        handler(session->snapshot());
+    }
+};
+
 // Session
 
 session_t::session_t(std::unique_ptr<channel<tcp>> transport_, const dispatch_ptr_t& prototype_):
     transport(std::shared_ptr<channel<tcp>>(std::move(transport_))),
     endpoint((*transport.synchronize())->socket->remote_endpoint()),
     prototype(prototype_),
-    max_channel_id(0)
+    max_channel_id(0),
+    backlog(0),
+    blocked(false),
+    high_watermark(0),
+    low_watermark(0),
+    received(0),
+    sent(0)
 {
     signals.shutdown.connect(0, discard_action_t(channels));
 }
@@ -190,66 +270,115 @@ session_t::session_t(std::unique_ptr<channel<tcp>> transport_, const dispatch_pt
 
 void
 session_t::invoke(const decoder_t::message_type& message) {
-    channel_map_t::const_iterator lb, ub;
     channel_map_t::key_type channel_id = message.span();
 
-    std::shared_ptr<channel_t> channel;
+    received++;
 
-    {
-        auto ptr = channels.synchronize();
+    auto it = channels.find(channel_id);
 
-        std::tie(lb, ub) = ptr->equal_range(channel_id);
+    if(it == channels.end()) {
+        auto current = max_channel_id.load();
 
-        if(lb == ub) {
-            if(channel_id <= max_channel_id) {
+        do {
+            if(channel_id <= current) {
                 // NOTE: Checking whether channel number is always higher than the previous channel
                 // number is similar to an infinite TIME_WAIT timeout for TCP sockets. It might be
                 // not the best approach, but since we have 2^64 possible channels, and it is a lot
                 // more than 2^16 ports for sockets, it is fit to avoid stray messages.
                 return;
             }
+        } while(!max_channel_id.compare_exchange_weak(current, channel_id));
+
+        std::tie(it, std::ignore) = channels.insert({channel_id, std::allocate_shared<channel_t>(
+            slab_allocator<channel_t>(),
+            prototype,
+            shared_from_this(),
+            channel_id
+        )});
+    }
 
-            max_channel_id = channel_id;
+    // NOTE: The virtual channel pointer is copied here so that if the slot decides to close the
+    // virtual channel, it won't destroy it inside the channel_t::process(). Instead, it will be
+    // destroyed when this function scope is exited, liberating us from thinking of some voodoo
+    // workaround magic.
+    const auto channel = it->second;
 
-            std::tie(lb, std::ignore) = ptr->insert({channel_id, std::make_shared<channel_t>(
-                prototype,
-                std::make_shared<basic_upstream_t>(shared_from_this(), channel_id)
-            )});
-        }
+    channel->process(message);
+}
+
+void
+session_t::insert(uint64_t channel_id, const std::shared_ptr<channel_t>& channel) {
+    channels.insert({channel_id, channel});
+}
 
-        // NOTE: The virtual channel pointer is copied here so that if the slot decides to close the
-        // virtual channel, it won't destroy it inside the channel_t::process(). Instead, it will be
-        // destroyed when this function scope is exited, liberating us from thinking of some voodoo
-        // workaround magic.
-        channel = lb->second;
+void
+session_t::erase(uint64_t channel_id) {
+    auto it = channels.find(channel_id);
+
+    if(it == channels.end()) {
+        return;
     }
 
-    channel->process(message);
+    // The channel itself might outlive the map entry, as long as its upstream is in use.
+    it->second->dispatch = nullptr;
+
+    channels.erase(it);
 }
 
 upstream_ptr_t
 session_t::inject(const dispatch_ptr_t& dispatch) {
-    auto ptr = channels.synchronize();
-
     const auto channel_id = ++max_channel_id;
-    const auto upstream = std::make_shared<basic_upstream_t>(shared_from_this(), channel_id);
+    const auto channel = std::allocate_shared<channel_t>(
+        slab_allocator<channel_t>(),
+        dispatch,
+        shared_from_this(),
+        channel_id
+    );
 
-    if(dispatch) {
-        ptr->insert({channel_id, std::make_shared<channel_t>(dispatch, upstream)});
+    if(!dispatch) {
+        return channel->ptr();
     }
 
-    return upstream;
+    if(const auto ptr = *transport.synchronize()) {
+        // NOTE: The channel is inserted before any message sent via the returned upstream is even
+        // scheduled for writing, so the response can't arrive before the channel is there.
+        ptr->socket->get_io_service().dispatch(std::bind(&session_t::insert,
+            shared_from_this(),
+            channel_id,
+            channel
+        ));
+    }
+
+    return channel->ptr();
 }
 
 void
 session_t::revoke(uint64_t channel_id) {
-    channels->erase(channel_id);
+    if(const auto ptr = *transport.synchronize()) {
+        ptr->socket->get_io_service().dispatch(std::bind(&session_t::erase,
+            shared_from_this(),
+            channel_id
+        ));
+    }
 }
 
 void
 session_t::detach() {
     *transport.synchronize() = nullptr;
 
+    // Break the reference cycle between the session and its paused read operation.
+    paused = nullptr;
+
+    std::vector<std::function<void()>> handlers;
+
+    // NOTE: The transport is reset before the waiters are picked up, and await() checks it while
+    // holding the waiters lock, so no producer is left waiting for a session which is gone.
+    std::swap(handlers, *waiters.synchronize());
+
+    for(auto it = handlers.begin(); it != handlers.end(); ++it) {
+        (*it)();
+    }
+
     // Detach all the signal handlers, because the session will be in detached state and triggering
     // more signals will result in an undefined behavior.
     signals.shutdown.disconnect_all_slots();
@@ -272,26 +401,149 @@ session_t::pull() {
 
 void
 session_t::push(encoder_t::message_type&& message) {
-    if(const auto ptr = *transport.synchronize()) {
-        // Use dispatch() instead of a direct call for thread safety.
-        ptr->socket->get_io_service().dispatch(std::bind(&push_action_t::operator(),
-            std::make_shared<push_action_t>(std::move(message), shared_from_this()),
-            ptr
-        ));
+    const auto ptr = *transport.synchronize();
+
+    if(!ptr) {
+        throw cocaine::error_t("session is not connected");
+    }
+
+    const size_t size = message.size();
+
+    sent += message.count();
+
+    // NOTE: The backlog is accounted before the message becomes visible to the flushing thread, so
+    // that the session is never left blocked after the message has been already written.
+    if(backlog.fetch_add(size) + size >= high_watermark && high_watermark) {
+        blocked = true;
+    }
+
+    {
+        auto batch = outbox.synchronize();
+
+        batch->push_back(std::move(message));
+
+        if(batch->size() > 1) {
+            // The flush has been already scheduled and hasn't picked up the outbox yet.
+            return;
+        }
+    }
+
+    const auto flush = std::allocate_shared<push_action_t>(
+        slab_allocator<push_action_t>(),
+        shared_from_this()
+    );
+
+    const auto action = std::bind(&push_action_t::operator(), flush, ptr);
+
+    if(ptr->writer->coalescing()) {
+        // Defer the flush until the end of the current reactor turn to batch all the messages pushed
+        // during this turn, even from the reactor thread itself.
+        ptr->socket->get_io_service().post(action);
     } else {
+        // Use dispatch() instead of a direct call for thread safety.
+        ptr->socket->get_io_service().dispatch(action);
+    }
+}
+
+void
+session_t::post(const std::function<void()>& handler) {
+    const auto ptr = *transport.synchronize();
+
+    if(!ptr) {
         throw cocaine::error_t("session is not connected");
     }
+
+    ptr->socket->get_io_service().post(handler);
+}
+
+void
+session_t::release(size_t bytes) {
+    if((backlog -= bytes) > low_watermark || !blocked.exchange(false)) {
+        return;
+    }
+
+    std::vector<std::function<void()>> handlers;
+
+    // NOTE: The blocked flag is cleared before the waiters are picked up, and await() checks it
+    // while holding the waiters lock, so no wake-up is ever lost.
+    std::swap(handlers, *waiters.synchronize());
+
+    const auto ptr = *transport.synchronize();
+
+    if(!ptr) {
+        // The session has been detached in the meantime, and the waiters taken out above are not
+        // going to be woken up by the detach anymore.
+        for(auto it = handlers.begin(); it != handlers.end(); ++it) {
+            (*it)();
+        }
+
+        return;
+    }
+
+    for(auto it = handlers.begin(); it != handlers.end(); ++it) {
+        ptr->socket->get_io_service().post(*it);
+    }
+
+    if(!paused) {
+        return;
+    }
+
+    const auto action = std::move(paused);
+
+    (*action)(ptr);
+}
+
+// Flow control
+
+void
+session_t::watermarks(size_t high, size_t low) {
+    high_watermark = high;
+    low_watermark  = std::min(low, high);
+}
+
+bool
+session_t::would_block() const {
+    return blocked;
+}
+
+void
+session_t::await(const std::function<void()>& handler) {
+    std::shared_ptr<channel<tcp>> ptr;
+
+    {
+        auto queue = waiters.synchronize();
+
+        if(!(ptr = *transport.synchronize())) {
+            throw cocaine::error_t("session is not connected");
+        }
+
+        if(blocked) {
+            queue->push_back(handler);
+            return;
+        }
+    }
+
+    ptr->socket->get_io_service().post(handler);
 }
 
 // Information
 
+void
+session_t::active_channels(const std::function<void(const channel_names_t&)>& handler) {
+    const auto ptr = *transport.synchronize();
+
+    if(!ptr) {
+        return handler(channel_names_t());
+    }
+
+    ptr->socket->get_io_service().post(snapshot_action_t(shared_from_this(), handler));
+}
+
 std::map<uint64_t, std::string>
-session_t::active_channels() const {
+session_t::snapshot() const {
     std::map<uint64_t, std::string> result;
 
-    auto ptr = channels.synchronize();
-
-    for(auto it = ptr->begin(); it != ptr->end(); ++it) {
+    for(auto it = channels.begin(); it != channels.end(); ++it) {
         result[it->first] = it->second->dispatch ? it->second->dispatch->name() : "<unassigned>";
     }
 
@@ -307,6 +559,27 @@ session_t::memory_pressure() const {
     }
 }
 
+write_stats_t
+session_t::write_stats() const {
+    if(const auto ptr = *transport.synchronize()) {
+        return ptr->writer->stats();
+    } else {
+        return write_stats_t();
+    }
+}
+
+session_t::stats_t
+session_t::stats() const {
+    stats_t result = { channels.size(), received, sent.load(), 0, 0 };
+
+    if(const auto ptr = *transport.synchronize()) {
+        result.pending_read  = ptr->reader->pressure();
+        result.pending_write = ptr->writer->pressure();
+    }
+
+    return result;
+}
+
 std::string
 session_t::name() const {
     return prototype ? prototype->name() : "<unassigned>";
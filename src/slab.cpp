@@ -0,0 +1,98 @@
+/*
+    Copyright (c) 2011-2014 Andrey Sibiryov <me@kobology.ru>
+    Copyright (c) 2011-2014 Other contributors as noted in the AUTHORS file.
+
+    This file is part of Cocaine.
+
+    Cocaine is free software; you can redistribute it and/or modify
+    it under the terms of the GNU Lesser General Public License as published by
+    the Free Software Foundation; either version 3 of the License, or
+    (at your option) any later version.
+
+    Cocaine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "cocaine/rpc/slab.hpp"
+
+#include <boost/thread/tss.hpp>
+
+using namespace cocaine::io;
+
+namespace {
+
+boost::thread_specific_ptr<slab_t> slab;
+
+} // namespace
+
+slab_t::slab_t() {
+    for(auto it = m_classes.begin(); it != m_classes.end(); ++it) {
+        it->head = nullptr;
+        it->size = 0;
+    }
+}
+
+slab_t::~slab_t() {
+    for(auto it = m_classes.begin(); it != m_classes.end(); ++it) {
+        while(block_t* block = it->head) {
+            it->head = block->next;
+            ::operator delete(block);
+        }
+    }
+}
+
+slab_t&
+slab_t::local() {
+    if(!slab.get()) {
+        slab.reset(new slab_t());
+    }
+
+    return *slab;
+}
+
+void*
+slab_t::allocate(size_t size) {
+    const size_t index = (size + kGranularity - 1) / kGranularity - 1;
+
+    if(index >= kClassCount) {
+        return ::operator new(size);
+    }
+
+    auto& cache = m_classes[index];
+
+    if(block_t* block = cache.head) {
+        cache.head = block->next;
+        cache.size--;
+
+        return block;
+    }
+
+    // All the blocks of the same class are of the same size, so they can be freely reused.
+    return ::operator new((index + 1) * kGranularity);
+}
+
+void
+slab_t::deallocate(void* ptr, size_t size) {
+    const size_t index = (size + kGranularity - 1) / kGranularity - 1;
+
+    if(index < kClassCount) {
+        auto& cache = m_classes[index];
+
+        if(cache.size < kMaxCachedBlocks) {
+            block_t* block = static_cast<block_t*>(ptr);
+
+            block->next = cache.head;
+            cache.head  = block;
+            cache.size++;
+
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
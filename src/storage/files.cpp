@@ -73,6 +73,13 @@ files_t::read(const std::string& collection, const std::string& key) {
 void
 files_t::write(const std::string& collection, const std::string& key, const std::string& blob,
                const std::vector<std::string>& tags)
+{
+    write(collection, key, blob.data(), blob.size(), tags);
+}
+
+void
+files_t::write(const std::string& collection, const std::string& key, const char* blob, size_t size,
+               const std::vector<std::string>& tags)
 {
     std::lock_guard<std::mutex> guard(m_mutex);
 
@@ -132,7 +139,7 @@ files_t::write(const std::string& collection, const std::string& key, const std:
         }
     }
 
-    stream.write(blob.c_str(), blob.size());
+    stream.write(blob, size);
     stream.close();
 }
 
@@ -13,7 +13,15 @@
 #include "cocaine/logging.hpp"
 
 #include "cocaine/rpc/dispatch.hpp"
+#include "cocaine/rpc/metrics.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <new>
 #include <random>
 
 #include <celero/Celero.h>
@@ -70,6 +78,71 @@ struct test {
             std::string
         >::tag upstream_type;
     };
+
+    struct chunk_slot {
+        typedef test_tag tag;
+
+        static const char* alias() {
+            return "chunk_slot";
+        }
+
+        typedef boost::mpl::list<
+            std::string
+        > argument_type;
+
+        // Keeps the channel open after every message.
+        typedef test_tag dispatch_type;
+
+        typedef void upstream_type;
+    };
+
+    struct deferred_slot {
+        typedef test_tag tag;
+
+        static const char* alias() {
+            return "deferred_slot";
+        }
+
+        typedef boost::mpl::list<
+            std::string
+        > argument_type;
+
+        typedef option_of<
+            std::string
+        >::tag upstream_type;
+    };
+
+    struct streamed_slot {
+        typedef test_tag tag;
+
+        static const char* alias() {
+            return "streamed_slot";
+        }
+
+        typedef boost::mpl::list<
+            std::string
+        > argument_type;
+
+        typedef stream_of<
+            std::string
+        >::tag upstream_type;
+    };
+
+    struct throttled_slot {
+        typedef test_tag tag;
+
+        static const char* alias() {
+            return "throttled_slot";
+        }
+
+        typedef boost::mpl::list<
+            std::string
+        > argument_type;
+
+        typedef stream_of<
+            std::string
+        >::tag upstream_type;
+    };
 };
 
 template<>
@@ -81,7 +154,11 @@ struct protocol<test_tag> {
     typedef boost::mpl::list<
         test::mute_slot,
         test::void_slot,
-        test::echo_slot
+        test::echo_slot,
+        test::chunk_slot,
+        test::deferred_slot,
+        test::streamed_slot,
+        test::throttled_slot
     > messages;
 
     typedef test scope;
@@ -89,6 +166,69 @@ struct protocol<test_tag> {
 
 } // namespace io
 
+// Streams a number of chunks, holding off whenever the client doesn't keep up with them, and
+// carrying on once the session's backlog drains.
+
+class throttled_producer_t:
+    public std::enable_shared_from_this<throttled_producer_t>
+{
+    streamed<std::string> stream;
+
+    const std::string chunk;
+    size_t remaining;
+
+public:
+    // Number of times the producers have been paused and resumed.
+    static std::atomic<uint64_t> paused;
+    static std::atomic<uint64_t> resumed;
+
+public:
+    throttled_producer_t(const streamed<std::string>& stream_, const std::string& chunk_,
+                         size_t count)
+    :
+        stream(stream_),
+        chunk(chunk_),
+        remaining(count)
+    { }
+
+    // Starts producing once the stream is attached to the client session.
+    void
+    start() {
+        stream.await(std::bind(&throttled_producer_t::operator(), shared_from_this()));
+    }
+
+    void
+    operator()() {
+        try {
+            while(remaining && !stream.would_block()) {
+                stream.write(chunk);
+                remaining--;
+            }
+
+            if(!remaining) {
+                stream.close();
+                return;
+            }
+
+            paused++;
+
+            stream.await(std::bind(&throttled_producer_t::resume, shared_from_this()));
+        } catch(const cocaine::error_t&) {
+            // The client has disconnected.
+        }
+    }
+
+private:
+    void
+    resume() {
+        resumed++;
+        operator()();
+    }
+};
+
+std::atomic<uint64_t> throttled_producer_t::paused;
+std::atomic<uint64_t> throttled_producer_t::resumed;
+
 struct test_service_t:
     public dispatch<io::test_tag>
 {
@@ -100,8 +240,15 @@ struct test_service_t:
         on<io::test::mute_slot>(std::bind(&test_service_t::on_mute_slot, this, _1));
         on<io::test::void_slot>(std::bind(&test_service_t::on_void_slot, this, _1));
         on<io::test::echo_slot>(std::bind(&test_service_t::on_echo_slot, this, _1));
+        on<io::test::chunk_slot>(std::bind(&test_service_t::on_chunk_slot, this, _1));
+        on<io::test::deferred_slot>(std::bind(&test_service_t::on_deferred_slot, this, _1));
+        on<io::test::streamed_slot>(std::bind(&test_service_t::on_streamed_slot, this, _1));
+        on<io::test::throttled_slot>(std::bind(&test_service_t::on_throttled_slot, this, _1));
     }
 
+    // Number of chunks streamed back for every streamed_slot invocation.
+    static const size_t kChunkCount = 4;
+
     void
     on_mute_slot(const std::string& COCAINE_UNUSED_(input)) {
         return;
@@ -116,20 +263,115 @@ struct test_service_t:
     on_echo_slot(const std::string& input) {
         return input;
     }
+
+    void
+    on_chunk_slot(const std::string& COCAINE_UNUSED_(input)) {
+        return;
+    }
+
+    deferred<std::string>
+    on_deferred_slot(const std::string& input) {
+        deferred<std::string> promise;
+
+        promise.write(input);
+
+        return promise;
+    }
+
+    streamed<std::string>
+    on_streamed_slot(const std::string& input) {
+        streamed<std::string> stream;
+
+        for(size_t i = 0; i < kChunkCount; ++i) {
+            stream.write(input);
+        }
+
+        stream.close();
+
+        return stream;
+    }
+
+    streamed<std::string>
+    on_throttled_slot(const std::string& input) {
+        streamed<std::string> stream;
+
+        std::make_shared<throttled_producer_t>(stream, input, kChunkCount)->start();
+
+        return stream;
+    }
 };
 
 } // namespace cocaine
 
+// Allocation tracking. Every allocation made by the process is counted, so that benchmarks could
+// report the number of allocations per message in both the client and the service. Allocations made
+// on the client threads, i.e. the benchmark thread and the client reactor thread, are also counted
+// separately, so that the service-side allocations could be told apart.
+
+static std::atomic<uint64_t> allocations;
+static std::atomic<uint64_t> client_allocations;
+
+// NOTE: Plain thread-local storage, because thread_specific_ptr allocates itself.
+static __thread bool client_thread = false;
+
+void*
+operator new(size_t size) throw(std::bad_alloc) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if(client_thread) {
+        client_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if(void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void*
+operator new[](size_t size) throw(std::bad_alloc) {
+    return operator new(size);
+}
+
+void
+operator delete(void* ptr) throw() {
+    std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) throw() {
+    std::free(ptr);
+}
+
 struct test_globals_t {
     test_globals_t() {
         std::random_device rd;
 
-        std::generate_n(std::back_inserter(data1K),  1024,  std::ref(rd));
-        std::generate_n(std::back_inserter(data8K),  8192,  std::ref(rd));
-        std::generate_n(std::back_inserter(data65K), 65536, std::ref(rd));
+        std::generate_n(std::back_inserter(data16),  16,      std::ref(rd));
+        std::generate_n(std::back_inserter(data1K),  1024,    std::ref(rd));
+        std::generate_n(std::back_inserter(data8K),  8192,    std::ref(rd));
+        std::generate_n(std::back_inserter(data65K), 65536,   std::ref(rd));
+        std::generate_n(std::back_inserter(data4M),  4194304, std::ref(rd));
+
+        // Message sizes from 16B to 4MB, with the number of messages of every size decreasing with
+        // the size, i.e. mostly small messages with occasional large ones, like in production.
+        size_t count = 256;
+
+        for(size_t size = 16; size <= data4M.size(); size *= 4) {
+            for(size_t i = 0; i < count; ++i) {
+                mixed.push_back(data4M.substr(0, size));
+            }
+
+            count = std::max<size_t>(count / 2, 1);
+        }
+
+        std::shuffle(mixed.begin(), mixed.end(), std::mt19937(rd()));
     }
 
-    std::string data1K, data8K, data65K;
+    std::string data16, data1K, data8K, data65K, data4M;
+
+    std::vector<std::string> mixed;
 };
 
 static
@@ -152,7 +394,36 @@ public:
     virtual
     void
     setUp(int64_t) {
-        context.reset(new cocaine::context_t(cocaine::config_t("cocaine-benchmark.conf"), "core"));
+        start(0);
+    }
+
+    virtual
+    void
+    tearDown() {
+        reactor->stop();
+        context->remove("benchmark");
+        chamber->join();
+    }
+
+protected:
+    // Zero pool size keeps the number of execution units specified in the configuration. Non-zero
+    // watermark enables the flow control, with the low watermark at a half of it.
+    void
+    start(size_t pool, size_t watermark = 0) {
+        cocaine::config_t config("cocaine-benchmark.conf");
+
+        if(pool) {
+            config.network.pool = pool;
+        }
+
+        if(watermark) {
+            config.network.watermarks.high = watermark;
+            config.network.watermarks.low  = watermark / 2;
+        }
+
+        client_thread = true;
+
+        context.reset(new cocaine::context_t(config, "core"));
         reactor.reset(new asio::io_service());
 
         context->insert("benchmark", std::make_unique<cocaine::actor_t>(
@@ -161,24 +432,488 @@ public:
             std::make_unique<cocaine::test_service_t>()
         ));
 
+        connect(service);
+
+        chamber.reset(new boost::thread([this]{ client_thread = true; reactor->run(); }));
+    }
+
+    void
+    connect(cocaine::api::details::basic_client_t& client) {
         auto endpoints = context->locate("benchmark").get().endpoints();
         auto socket = std::make_unique<asio::ip::tcp::socket>(*reactor);
 
         asio::connect(*socket, endpoints.begin(), endpoints.end());
 
-        service.connect(std::move(socket));
-        chamber.reset(new boost::thread([this]{ reactor->run(); }));
+        client.connect(std::move(socket));
+    }
+
+};
+
+// Sends messages round-robin into a number of simultaneously open channels of the same session, to
+// see how the session channel table scales with the number of multiplexed channels.
+
+template<size_t Channels>
+struct multiplex_fixture_t:
+    public test_fixture_t
+{
+    std::vector<cocaine::upstream<cocaine::io::test_tag>> channels;
+    size_t counter;
+
+public:
+    virtual
+    void
+    setUp(int64_t value) {
+        test_fixture_t::setUp(value);
+
+        for(size_t i = 0; i < Channels; ++i) {
+            channels.push_back(service.invoke<cocaine::io::test::chunk_slot>(nullptr, std::string()));
+        }
+
+        counter = 0;
     }
 
     virtual
     void
     tearDown() {
-        reactor->stop();
-        context->remove("benchmark");
-        chamber->join();
+        channels.clear();
+        test_fixture_t::tearDown();
+    }
+
+    void
+    send(const std::string& data) {
+        auto& channel = channels[counter++ % Channels];
+        channel = channel.send<cocaine::io::test::chunk_slot>(data);
+    }
+};
+
+// Waits for replies to a batch of requests. Replies are received on the client reactor thread.
+
+class latch_t {
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    size_t pending;
+
+public:
+    latch_t():
+        pending(0)
+    { }
+
+    void
+    reset(size_t count) {
+        std::lock_guard<std::mutex> guard(mutex);
+        pending = count;
+    }
+
+    void
+    count_down() {
+        std::lock_guard<std::mutex> guard(mutex);
+
+        if(pending && --pending == 0) {
+            condition.notify_all();
+        }
+    }
+
+    void
+    wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        while(pending) {
+            condition.wait(lock);
+        }
+    }
+};
+
+// Tracks a single outstanding request: its latency is measured from the moment the reply dispatch
+// is constructed, i.e. right before the request is sent, until the reply is complete.
+
+class request_t {
+    typedef cocaine::io::slot_metrics_t::clock_type clock_type;
+
+    latch_t& latch;
+
+    // Request latencies in microseconds, shared by all the requests of the experiment.
+    cocaine::io::histogram_t& latency;
+
+    const clock_type::time_point start;
+
+public:
+    request_t(latch_t& latch_, cocaine::io::histogram_t& latency_):
+        latch(latch_),
+        latency(latency_),
+        start(clock_type::now())
+    { }
+
+    void
+    complete() const {
+        latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            clock_type::now() - start
+        ).count());
+
+        latch.count_down();
+    }
+
+    // Requests with a broken channel are not accounted in latencies.
+    void
+    abandon() const {
+        latch.count_down();
+    }
+};
+
+// Client-side dispatches for the replies, each of them completes a single request.
+
+class value_reply_t:
+    public cocaine::dispatch<cocaine::io::option_of<std::string>::tag>
+{
+    const request_t request;
+
+public:
+    value_reply_t(latch_t& latch, cocaine::io::histogram_t& latency):
+        cocaine::dispatch<cocaine::io::option_of<std::string>::tag>("value_reply"),
+        request(latch, latency)
+    {
+        typedef cocaine::io::protocol<cocaine::io::option_of<std::string>::tag>::scope protocol;
+
+        using namespace std::placeholders;
+
+        on<protocol::value>(std::bind(&value_reply_t::on_value, this, _1));
+        on<protocol::error>(std::bind(&value_reply_t::on_error, this, _1, _2));
+    }
+
+    virtual
+    void
+    discard(const std::error_code& COCAINE_UNUSED_(ec)) const {
+        request.abandon();
+    }
+
+private:
+    void
+    on_value(const std::string& COCAINE_UNUSED_(value)) {
+        request.complete();
+    }
+
+    void
+    on_error(int COCAINE_UNUSED_(code), const std::string& COCAINE_UNUSED_(reason)) {
+        request.complete();
+    }
+};
+
+class stream_reply_t:
+    public cocaine::dispatch<cocaine::io::stream_of<std::string>::tag>
+{
+    const request_t request;
+
+public:
+    stream_reply_t(latch_t& latch, cocaine::io::histogram_t& latency):
+        cocaine::dispatch<cocaine::io::stream_of<std::string>::tag>("stream_reply"),
+        request(latch, latency)
+    {
+        typedef cocaine::io::protocol<cocaine::io::stream_of<std::string>::tag>::scope protocol;
+
+        using namespace std::placeholders;
+
+        on<protocol::chunk>(std::bind(&stream_reply_t::on_chunk, this, _1));
+        on<protocol::error>(std::bind(&stream_reply_t::on_error, this, _1, _2));
+        on<protocol::choke>(std::bind(&stream_reply_t::on_choke, this));
+    }
+
+    virtual
+    void
+    discard(const std::error_code& COCAINE_UNUSED_(ec)) const {
+        request.abandon();
+    }
+
+private:
+    void
+    on_chunk(const std::string& COCAINE_UNUSED_(chunk)) {
+        return;
+    }
+
+    void
+    on_error(int COCAINE_UNUSED_(code), const std::string& COCAINE_UNUSED_(reason)) {
+        request.complete();
+    }
+
+    void
+    on_choke() {
+        request.complete();
+    }
+};
+
+// Measures request latencies and allocations per message over all the samples of the experiment,
+// and reports them when the experiment is complete. Celero only reports the throughput.
+
+struct measured_fixture_t:
+    public test_fixture_t
+{
+    latch_t latch;
+
+    // Request latencies in microseconds, recorded by every reply as it completes.
+    std::unique_ptr<cocaine::io::histogram_t> latency;
+
+    uint64_t messages;
+
+    // Allocations made by the whole process and by the client threads only.
+    uint64_t allocated;
+    uint64_t allocated_by_client;
+
+    // Allocation counters at the beginning of the current sample.
+    uint64_t baseline;
+    uint64_t client_baseline;
+
+    // Number of messages in the current sample.
+    uint64_t pending;
+
+public:
+    measured_fixture_t():
+        latency(new cocaine::io::histogram_t()),
+        messages(0),
+        allocated(0),
+        allocated_by_client(0),
+        baseline(0),
+        client_baseline(0),
+        pending(0)
+    { }
+
+    virtual
+   ~measured_fixture_t() {
+        if(!messages) {
+            return;
+        }
+
+        std::cout << "    " << messages << " message(s), ";
+
+        if(latency->count()) {
+            std::cout << "latency"
+                      << " p50: "  << latency->percentile(0.5)   << "us,"
+                      << " p99: "  << latency->percentile(0.99)  << "us,"
+                      << " p999: " << latency->percentile(0.999) << "us, ";
+        }
+
+        const uint64_t allocated_by_service = allocated - allocated_by_client;
+
+        std::cout << static_cast<double>(allocated) / messages << " allocation(s) per message, "
+                  << static_cast<double>(allocated_by_service) / messages << " in the service"
+                  << std::endl;
+    }
+
+    virtual
+    void
+    setUp(int64_t) {
+        start(0);
+        begin();
+    }
+
+    virtual
+    void
+    tearDown() {
+        // Samples which haven't sent anything are not accounted.
+        if(pending) {
+            barrier();
+
+            allocated           += allocations.load() - baseline;
+            allocated_by_client += client_allocations.load() - client_baseline;
+
+            messages += pending;
+        }
+
+        test_fixture_t::tearDown();
+    }
+
+    // Sends a one-shot request without waiting for the reply.
+    template<class Event>
+    void
+    invoke(const std::string& data) {
+        service.invoke<Event>(nullptr, data);
+        pending++;
+    }
+
+protected:
+    void
+    begin() {
+        pending = 0;
+
+        baseline        = allocations.load();
+        client_baseline = client_allocations.load();
+    }
+
+    // Waits until the service has processed all the requests sent so far. The session handles its
+    // messages in order, so once the reply to an echo request arrives, all the one-shot requests
+    // sent before it have been processed too. Its own allocations are negligible over the sample.
+    void
+    barrier() {
+        cocaine::io::histogram_t discarded;
+
+        latch.reset(1);
+
+        service.invoke<cocaine::io::test::echo_slot>(
+            std::make_shared<value_reply_t>(latch, discarded),
+            std::string()
+        );
+
+        latch.wait();
+    }
+
+    // Sends one request per client and waits for all the replies.
+    template<class Event, class Reply>
+    void
+    roundtrip(const std::vector<cocaine::api::client<cocaine::io::test_tag>*>& clients,
+              const std::string& data)
+    {
+        latch.reset(clients.size());
+
+        for(auto it = clients.begin(); it != clients.end(); ++it) {
+            (*it)->invoke<Event>(std::make_shared<Reply>(latch, *latency), data);
+        }
+
+        latch.wait();
+
+        pending += clients.size();
+    }
+};
+
+// Sends requests one by one and waits for every reply, with the given number of execution units.
+
+template<size_t Pool>
+struct roundtrip_fixture_t:
+    public measured_fixture_t
+{
+    std::vector<cocaine::api::client<cocaine::io::test_tag>*> clients;
+    size_t counter;
+
+public:
+    virtual
+    void
+    setUp(int64_t) {
+        start(Pool);
+
+        clients.assign(1, &service);
+        counter = 0;
+
+        begin();
+    }
+
+    template<class Event, class Reply>
+    void
+    send(const std::string& data) {
+        roundtrip<Event, Reply>(clients, data);
+    }
+
+    // Cycles through the payloads of different sizes.
+    template<class Event, class Reply>
+    void
+    send(const std::vector<std::string>& data) {
+        roundtrip<Event, Reply>(clients, data[counter++ % data.size()]);
     }
 };
 
+// Sends a request into every one of the concurrent sessions at once, then waits for all of them.
+
+template<size_t Sessions, size_t Pool>
+struct sessions_fixture_t:
+    public measured_fixture_t
+{
+    std::vector<std::unique_ptr<cocaine::api::client<cocaine::io::test_tag>>> sessions;
+    std::vector<cocaine::api::client<cocaine::io::test_tag>*> clients;
+
+public:
+    virtual
+    void
+    setUp(int64_t) {
+        start(Pool);
+
+        clients.assign(1, &service);
+
+        for(size_t i = 1; i < Sessions; ++i) {
+            sessions.emplace_back(new cocaine::api::client<cocaine::io::test_tag>());
+            connect(*sessions.back());
+            clients.push_back(sessions.back().get());
+        }
+
+        begin();
+    }
+
+    virtual
+    void
+    tearDown() {
+        measured_fixture_t::tearDown();
+
+        clients.clear();
+        sessions.clear();
+    }
+
+    void
+    send(const std::string& data) {
+        roundtrip<cocaine::io::test::echo_slot, value_reply_t>(clients, data);
+    }
+};
+
+// Streams chunks larger than the session's high watermark, so that the producer has to pause after
+// every chunk until the client catches up. Every stream is complete by the end of the round trip,
+// so every pause must have been followed by a resume, otherwise the producer would have stalled.
+
+struct throttled_fixture_t:
+    public measured_fixture_t
+{
+    static const size_t kWatermark = 16384;
+
+    std::vector<cocaine::api::client<cocaine::io::test_tag>*> clients;
+
+public:
+    virtual
+   ~throttled_fixture_t() {
+        const uint64_t paused = throttled_producer_t::paused.load();
+
+        if(!messages) {
+            return;
+        }
+
+        std::cout << "    producers paused " << paused << " time(s)" << std::endl;
+
+        if(!paused) {
+            std::cerr << "    producers have never been throttled" << std::endl;
+            std::abort();
+        }
+    }
+
+    virtual
+    void
+    setUp(int64_t) {
+        start(0, kWatermark);
+
+        clients.assign(1, &service);
+
+        begin();
+    }
+
+    virtual
+    void
+    tearDown() {
+        measured_fixture_t::tearDown();
+
+        if(throttled_producer_t::paused.load() != throttled_producer_t::resumed.load()) {
+            std::cerr << "    producers have been paused, but never resumed" << std::endl;
+            std::abort();
+        }
+    }
+
+    void
+    send(const std::string& data) {
+        roundtrip<cocaine::io::test::throttled_slot, stream_reply_t>(clients, data);
+    }
+};
+
+typedef roundtrip_fixture_t<0> roundtrip_t;
+
+typedef sessions_fixture_t<1,   0> sessions_1_t;
+typedef sessions_fixture_t<16,  0> sessions_16_t;
+typedef sessions_fixture_t<256, 0> sessions_256_t;
+
+typedef sessions_fixture_t<64,  1> units_1_t;
+typedef sessions_fixture_t<64,  2> units_2_t;
+typedef sessions_fixture_t<64,  4> units_4_t;
+typedef sessions_fixture_t<64,  8> units_8_t;
+
 BASELINE_F (ClientIoBenchmark1K,  MuteSlot, test_fixture_t, 10, 100000) {
     service.invoke<cocaine::io::test::mute_slot>(nullptr, globals().data1K);
 }
@@ -215,4 +950,97 @@ BENCHMARK_F(ClientIoBenchmark65K, EchoSlot, test_fixture_t, 10, 100000) {
     service.invoke<cocaine::io::test::echo_slot>(nullptr, globals().data65K);
 }
 
+BASELINE_F (MultiplexedChannels1K, Channels1,    multiplex_fixture_t<1>,    10, 100000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(MultiplexedChannels1K, Channels64,   multiplex_fixture_t<64>,   10, 100000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(MultiplexedChannels1K, Channels4096, multiplex_fixture_t<4096>, 10, 100000) {
+    send(globals().data1K);
+}
+
+// Allocations per one-shot request, i.e. the cost of opening and closing a channel on both sides,
+// with the service's share reported separately.
+
+BASELINE_F (ChannelLifecycle, MuteSlot16, measured_fixture_t, 10, 100000) {
+    invoke<cocaine::io::test::mute_slot>(globals().data16);
+}
+
+BENCHMARK_F(ChannelLifecycle, VoidSlot16, measured_fixture_t, 10, 100000) {
+    invoke<cocaine::io::test::void_slot>(globals().data16);
+}
+
+// Round-trip latency of every slot kind.
+
+BASELINE_F (RoundTrip1K, EchoSlot,     roundtrip_t, 10, 10000) {
+    send<cocaine::io::test::echo_slot, value_reply_t>(globals().data1K);
+}
+
+BENCHMARK_F(RoundTrip1K, DeferredSlot, roundtrip_t, 10, 10000) {
+    send<cocaine::io::test::deferred_slot, value_reply_t>(globals().data1K);
+}
+
+BENCHMARK_F(RoundTrip1K, StreamedSlot, roundtrip_t, 10, 10000) {
+    send<cocaine::io::test::streamed_slot, stream_reply_t>(globals().data1K);
+}
+
+// Message sizes from 16B to 4MB.
+
+BASELINE_F (RoundTripSizes, EchoSlot16,    roundtrip_t, 10, 10000) {
+    send<cocaine::io::test::echo_slot, value_reply_t>(globals().data16);
+}
+
+BENCHMARK_F(RoundTripSizes, EchoSlot4M,    roundtrip_t, 10, 100) {
+    send<cocaine::io::test::echo_slot, value_reply_t>(globals().data4M);
+}
+
+BENCHMARK_F(RoundTripSizes, EchoMixed,     roundtrip_t, 10, 1000) {
+    send<cocaine::io::test::echo_slot, value_reply_t>(globals().mixed);
+}
+
+BENCHMARK_F(RoundTripSizes, StreamedMixed, roundtrip_t, 10, 1000) {
+    send<cocaine::io::test::streamed_slot, stream_reply_t>(globals().mixed);
+}
+
+// Producers throttled by the flow control, i.e. pausing whenever the client falls behind.
+
+BASELINE_F (FlowControl, Throttled65K, throttled_fixture_t, 10, 100) {
+    send(globals().data65K);
+}
+
+// Many concurrent client sessions.
+
+BASELINE_F (ConcurrentSessions1K, Sessions1,   sessions_1_t,   10, 1000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(ConcurrentSessions1K, Sessions16,  sessions_16_t,  10, 1000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(ConcurrentSessions1K, Sessions256, sessions_256_t, 10, 100) {
+    send(globals().data1K);
+}
+
+// Execution unit pool sizes, with enough sessions to keep all of them busy.
+
+BASELINE_F (ExecutionUnits1K, Units1, units_1_t, 10, 1000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(ExecutionUnits1K, Units2, units_2_t, 10, 1000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(ExecutionUnits1K, Units4, units_4_t, 10, 1000) {
+    send(globals().data1K);
+}
+
+BENCHMARK_F(ExecutionUnits1K, Units8, units_8_t, 10, 1000) {
+    send(globals().data1K);
+}
+
 CELERO_MAIN